@@ -9,8 +9,15 @@
 #include <iostream>
 #include <filesystem>
 #include <string>
-#include <assert.h>
 #include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
 
 using namespace std;
 
@@ -34,15 +41,20 @@ namespace fs = boost::filesystem;
         if (h == nullptr)
         {
             auto error = GetLastError();
-            cout << "Failed to load plugin: " << error << endl;
+            wcout << L"Failed to load " << path << L": " << error << endl;
+            exit(1);
         }
-        assert(h != nullptr);
         return (void*)h;
     }
     void* get_export(void* h, const char* name)
     {
         void* f = ::GetProcAddress((HMODULE)h, name);
-        assert(f != nullptr);
+        if (f == nullptr)
+        {
+            auto error = GetLastError();
+            cout << "Failed to find the export " << name << ": " << error << endl;
+            exit(1);
+        }
         return f;
     }
 #else
@@ -55,13 +67,21 @@ namespace fs = boost::filesystem;
     void* load_library(const char* path)
     {
         void* h = dlopen(path, RTLD_LAZY | RTLD_GLOBAL);
-        assert(h != nullptr);
+        if (h == nullptr)
+        {
+            cout << "Failed to load " << path << ": " << dlerror() << endl;
+            exit(1);
+        }
         return h;
     }
     void* get_export(void* h, const char* name)
     {
         void* f = dlsym(h, name);
-        assert(f != nullptr);
+        if (f == nullptr)
+        {
+            cout << "Failed to find the export " << name << ": " << dlerror() << endl;
+            exit(1);
+        }
         return f;
     }
 #endif
@@ -72,59 +92,1093 @@ typedef void (*XPluginStop)(void);
 typedef int  (*XPluginEnable)(void);
 typedef void (*XPluginDisable)(void);
 typedef void (*XPluginReceiveMessage)(int inFrom, int inMsg, void* inParam);
+typedef void (*SimSetPluginInfo)(int id, const char* name, const char* signature, const char* description);
+typedef int  (*SimSetCurrentPlugin)(int id);
+typedef int  (*SimRunFrame)(float frameSeconds);
+typedef int  (*SimDrawFrame)(void);
+typedef void (*SimTimingVisitor)(int plugin, const char* phase, long long calls, double totalMs, double maxMs, void* refcon);
+typedef void (*SimVisitTimings)(SimTimingVisitor visitor, void* refcon);
+typedef void (*SimResetTimings)(void);
+typedef void* (*SimDefineDataRef)(const char* name, int type, int length, int writable);
+typedef void* (*XPLMFindDataRef)(const char* name);
+typedef int  (*XPLMGetDatai)(void* dataRef);
+typedef void (*XPLMSetDatai)(void* dataRef, int value);
+typedef int  (*XPLMGetDatavf)(void* dataRef, float* values, int offset, int max);
+typedef void (*XPLMSetDataf)(void* dataRef, float value);
+typedef void (*XPLMSetDatad)(void* dataRef, double value);
+typedef void (*XPLMSetDatavf)(void* dataRef, float* values, int offset, int count);
+typedef int  (*SimStartRecording)(const char* path);
+typedef int  (*SimStopRecording)(void);
+typedef int  (*SimStartReplay)(const char* path, int loop);
+typedef void (*SimStopReplay)(void);
+typedef int  (*SimLoadNavData)(const char* path);
+typedef int  (*XPLMFindNavAid)(const char* nameFragment, const char* idFragment, float* lat, float* lon, int* frequency, int type);
+typedef void (*XPLMGetNavAidInfo)(int ref, int* type, float* lat, float* lon, float* height, int* frequency, float* heading, char* id, char* name, char* reg);
+typedef int  (*SimLoadTerrain)(const char* path);
+typedef void* (*XPLMCreateProbe)(int type);
+typedef void (*XPLMDestroyProbe)(void* probe);
+typedef int  (*XPLMProbeTerrainXYZ)(void* probe, float x, float y, float z, struct probe_info* info);
+typedef void* (*XPLMLoadObject)(const char* path);
+typedef void (*XPLMUnloadObject)(void* object);
+typedef void* (*XPLMCreateInstance)(void* object, const char** datarefs);
+typedef void (*XPLMDestroyInstance)(void* instance);
+typedef void (*XPLMInstanceSetPosition)(void* instance, const struct draw_info* position, const float* data);
+typedef void (*SimInstanceSetPositions)(void* const* instances, int count, const struct draw_info* positions, const float* data, const int* data_offsets);
+typedef int  (*SimGetInstancePosition)(void* instance, struct draw_info* position, float* data, int max_data);
+typedef void* (*XPLMCreateCommand)(const char* name, const char* description);
+typedef int  (*XPLMCommandCallback)(void* command, int phase, void* refcon);
+typedef void (*XPLMRegisterCommandHandler)(void* command, XPLMCommandCallback handler, int before, void* refcon);
+typedef void (*XPLMCommandOnce)(void* command);
+typedef int  (*SimFireCommand)(void* command, int count);
+typedef int  (*SimProbeTerrainBatch)(void* probe, const float* points, int count, struct probe_info* infos, int* results);
+typedef void (*XPLMDrawWindow)(void* window, void* refcon);
+typedef void* (*XPLMCreateWindowEx)(struct create_window_params* params);
+typedef void (*XPLMDestroyWindow)(void* window);
+typedef void (*XPLMBringWindowToFront)(void* window);
+typedef int  (*XPLMIsWindowInFront)(void* window);
 
 
+using clock_type = std::chrono::steady_clock;
+
+static double elapsed_ms(clock_type::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - since).count();
+}
+
 #if defined(WINDOWS)
-int __cdecl wmain(int argc, wchar_t* argv[])
+    #define popen _wpopen
+    #define pclose _pclose
+    #define POPEN_READ L"r"
+    void set_environment_variable(const wchar_t* name, const wchar_t* value)
+    {
+        _wputenv_s(name, value);
+    }
 #else
-int main(int argc, char* argv[])
+    #define POPEN_READ "r"
+    void set_environment_variable(const char* name, const char* value)
+    {
+        setenv(name, value, 1);
+    }
 #endif
+
+fs::path get_xplm_path(const fs::path& startup_folder)
 {
-	auto startup_folder = fs::canonical(fs::path(argv[0]).parent_path());
     auto plugins_folder = startup_folder / STR("Resources") / STR("plugins");
-    auto sample_plugin_folder = plugins_folder / STR("sample") / XP_PLATFORM;
-    auto sample_plugin_path = sample_plugin_folder / STR("sample.xpl");
-    assert(fs::exists(sample_plugin_path));
 #if defined(WINDOWS)
-    AddDllDirectory(plugins_folder.c_str());
-    AddDllDirectory(sample_plugin_folder.c_str());
-    auto xplm_path = plugins_folder / STR("XPLM_64.dll");
-    auto xplm_handle = load_library(xplm_path.c_str());
-    char plugin_path_utf8[256];
-    WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, sample_plugin_path.c_str(), -1, plugin_path_utf8, 256, NULL, NULL);
-    auto register_plugin = (SimRegisterPlugin)get_export(xplm_handle, "SimRegisterPlugin");
-    register_plugin(1, plugin_path_utf8);
+    return plugins_folder / STR("XPLM_64.dll");
+#elif LIN
+    return plugins_folder / STR("XPLM_64.so");
 #else
-#if LIN
-    auto xplm_path = plugins_folder / STR("XPLM_64.so");
+    return plugins_folder / STR("XPLM.framework") / STR("XPLM");
+#endif
+}
+
+#if defined(WINDOWS)
+    #define XP_FAT_PLUGIN_NAME STR("win.xpl")
+#elif APL
+    #define XP_FAT_PLUGIN_NAME STR("mac.xpl")
 #else
-    auto xplm_path = plugins_folder / STR("XPLM.framework") / STR("XPLM");
+    #define XP_FAT_PLUGIN_NAME STR("lin.xpl")
+#endif
+
+// Finds the plugins the way X-Plane does: <folder>/<platform>/<folder>.xpl, the older fat plugin layout
+// <folder>/<platform>.xpl, and the .xpl files in the plugins folder itself. The order is deterministic.
+std::vector<fs::path> discover_plugins(const fs::path& plugins_folder)
+{
+    std::vector<fs::path> paths;
+    for (auto& entry : fs::directory_iterator(plugins_folder))
+    {
+        auto& path = entry.path();
+        if (entry.is_directory())
+        {
+            auto plugin_path = path / XP_PLATFORM / (path.filename().native() + STR(".xpl"));
+            auto fat_plugin_path = path / XP_FAT_PLUGIN_NAME;
+            if (fs::exists(plugin_path))
+            {
+                paths.push_back(plugin_path);
+            }
+            else if (fs::exists(fat_plugin_path))
+            {
+                paths.push_back(fat_plugin_path);
+            }
+        }
+        else if (path.extension() == STR(".xpl"))
+        {
+            paths.push_back(path);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+struct plugin
+{
+    int id;
+    fs::path path;
+    std::string name;
+    XPluginStart start;
+    XPluginStop stop;
+    XPluginEnable enable;
+    XPluginDisable disable;
+    XPluginReceiveMessage receive_message;
+    bool started;
+    bool enabled;
+};
+
+struct phase_timing
+{
+    int plugin_id;
+    std::string phase;
+    long long calls;
+    double total_ms;
+    double max_ms;
+};
+
+static void collect_timing(int plugin_id, const char* phase, long long calls, double total_ms, double max_ms, void* refcon)
+{
+    ((std::vector<phase_timing>*)refcon)->push_back(phase_timing { plugin_id, phase, calls, total_ms, max_ms });
+}
+
+static void print_timings(const std::vector<plugin>& plugins, std::vector<phase_timing> timings)
+{
+    std::sort(timings.begin(), timings.end(), [](auto& a, auto& b) {
+        return a.plugin_id != b.plugin_id ? a.plugin_id < b.plugin_id : a.phase < b.phase;
+    });
+    for (auto& timing : timings)
+    {
+        auto value = std::find_if(plugins.begin(), plugins.end(), [&](const plugin& p) { return p.id == timing.plugin_id; });
+        printf("  %2d %-24s %-24s calls=%-10lld total=%10.2fms avg=%8.2fus max=%8.2fus\n",
+            timing.plugin_id,
+            value != plugins.end() ? value->name.c_str() : "?",
+            timing.phase.c_str(),
+            timing.calls,
+            timing.total_ms,
+            timing.total_ms * 1e3 / timing.calls,
+            timing.max_ms * 1e3);
+    }
+}
+
+// The dataref trace options: --record writes the dataref changes of the run to a trace file,
+// and --replay serves the datarefs from a trace file recorded earlier.
+struct trace_options
+{
+    std::string record_path;
+    std::string replay_path;
+};
+
+// A simple scripted flight, which gives the recorder a set of simulator datarefs changing every frame.
+class synthetic_flight
+{
+private:
+    void* latitude = nullptr;
+    void* longitude = nullptr;
+    void* elevation = nullptr;
+    void* heading = nullptr;
+    void* airspeed = nullptr;
+    void* engine_n1 = nullptr;
+    XPLMSetDataf set_dataf = nullptr;
+    XPLMSetDatad set_datad = nullptr;
+    XPLMSetDatavf set_datavf = nullptr;
+
+public:
+    void define(void* xplm_handle)
+    {
+        auto define_dataref = (SimDefineDataRef)get_export(xplm_handle, "SimDefineDataRef");
+        set_dataf = (XPLMSetDataf)get_export(xplm_handle, "XPLMSetDataf");
+        set_datad = (XPLMSetDatad)get_export(xplm_handle, "XPLMSetDatad");
+        set_datavf = (XPLMSetDatavf)get_export(xplm_handle, "XPLMSetDatavf");
+
+        // xplmType_Float = 2, xplmType_Double = 4, xplmType_FloatArray = 8
+        latitude = define_dataref("sim/flightmodel/position/latitude", 4, 1, 1);
+        longitude = define_dataref("sim/flightmodel/position/longitude", 4, 1, 1);
+        elevation = define_dataref("sim/flightmodel/position/elevation", 4, 1, 1);
+        heading = define_dataref("sim/flightmodel/position/psi", 2, 1, 1);
+        airspeed = define_dataref("sim/flightmodel/position/indicated_airspeed", 2, 1, 1);
+        engine_n1 = define_dataref("sim/flightmodel/engine/ENGN_N1_", 8, 8, 1);
+    }
+
+    // Climbs out and turns; the engines are set only every second, like the slower simulator datarefs.
+    void update(int frame, float frame_seconds)
+    {
+        auto t = frame * frame_seconds;
+        set_datad(latitude, 47.46 + t * 1e-4);
+        set_datad(longitude, 8.55 + t * 5e-5);
+        set_datad(elevation, 432 + t * 5);
+        set_dataf(heading, fmodf(140 + t * 3, 360));
+        set_dataf(airspeed, std::min(160.0f, 60 + t * 2));
+        if (frame % 60 == 0)
+        {
+            float n1[8] = { 90 + fmodf(t, 5), 90 + fmodf(t, 5) };
+            set_datavf(engine_n1, n1, 0, 8);
+        }
+    }
+};
+
+// Runs the given number of frames on the virtual clock of sim_xplm as fast as possible: each frame dispatches
+// the flight loops and the draw callbacks. Reports the throughput and the time spent per plugin and phase.
+// If flight is given, it is advanced before every frame.
+void run_frames(void* xplm_handle, const std::vector<plugin>& plugins, int frames, synthetic_flight* flight = nullptr)
+{
+    const float frame_seconds = 1.0f / 60;
+    auto run_frame = (SimRunFrame)get_export(xplm_handle, "SimRunFrame");
+    auto draw_frame = (SimDrawFrame)get_export(xplm_handle, "SimDrawFrame");
+    auto reset_timings = (SimResetTimings)get_export(xplm_handle, "SimResetTimings");
+    auto visit_timings = (SimVisitTimings)get_export(xplm_handle, "SimVisitTimings");
+
+    reset_timings();
+    long long callbacks = 0;
+    auto begin = clock_type::now();
+    for (int i = 0; i < frames; i++)
+    {
+        if (flight != nullptr)
+        {
+            flight->update(i, frame_seconds);
+        }
+        callbacks += run_frame(frame_seconds);
+        callbacks += draw_frame();
+    }
+    auto ms = elapsed_ms(begin);
+    printf("frames=%d virtual_time=%.1fs wall_time=%.1fms frames_per_second=%.0f callbacks=%lld callbacks_per_second=%.0f\n",
+        frames, frames * frame_seconds, ms, frames * 1e3 / ms, callbacks, callbacks * 1e3 / ms);
+
+    std::vector<phase_timing> timings;
+    visit_timings(collect_timing, &timings);
+    print_timings(plugins, timings);
+}
+
+// Loads the navaids like X-Plane, from Custom Data if the file is there, and otherwise from the default data.
+fs::path get_nav_data_path(const fs::path& startup_folder)
+{
+    auto custom_path = startup_folder / STR("Custom Data") / STR("earth_nav.dat");
+    return fs::exists(custom_path)
+        ? custom_path
+        : startup_folder / STR("Resources") / STR("default data") / STR("earth_nav.dat");
+}
+
+// The terrain is an optional heightfield tile set in the format read by SimLoadTerrain, see sim_xplm/XPLMScenery.cpp.
+fs::path get_terrain_path(const fs::path& startup_folder)
+{
+    return startup_folder / STR("Custom Data") / STR("terrain.xphf");
+}
+
+// Sends a message to every enabled plugin, as X-Plane does.
+typedef std::function<void(int message, void* param)> send_message_function;
+
+// Runs after the frames, while the plugins are enabled, and sends them messages.
+typedef std::function<void(const send_message_function& send_message)> plugin_script;
+
+// Loads, starts and enables every plugin under Resources/plugins, runs the given number of frames and the script,
+// and then disables and stops them. startup_ms receives the time spent in loading, starting and enabling all plugins.
+int run_plugins(const fs::path& startup_folder, double& startup_ms, int frames = 0, const trace_options& trace = {},
+    const plugin_script& script = {})
+{
+    auto plugins_folder = startup_folder / STR("Resources") / STR("plugins");
+#if defined(WINDOWS)
+    AddDllDirectory(plugins_folder.c_str());
 #endif
-    auto xplm_handle = load_library(xplm_path.c_str());
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
     auto register_plugin = (SimRegisterPlugin)get_export(xplm_handle, "SimRegisterPlugin");
-    register_plugin(1, sample_plugin_path.c_str());
+    auto set_plugin_info = (SimSetPluginInfo)get_export(xplm_handle, "SimSetPluginInfo");
+    auto set_current_plugin = (SimSetCurrentPlugin)get_export(xplm_handle, "SimSetCurrentPlugin");
 
+    auto nav_data_path = get_nav_data_path(startup_folder);
+    if (fs::exists(nav_data_path))
+    {
+        auto load_nav_data = (SimLoadNavData)get_export(xplm_handle, "SimLoadNavData");
+        printf("navaids=%d\n", load_nav_data(nav_data_path.u8string().c_str()));
+    }
+
+    auto terrain_path = get_terrain_path(startup_folder);
+    if (fs::exists(terrain_path))
+    {
+        auto load_terrain = (SimLoadTerrain)get_export(xplm_handle, "SimLoadTerrain");
+        printf("terrain_tiles=%d\n", load_terrain(terrain_path.u8string().c_str()));
+    }
+
+    // The traced datarefs are defined before the plugins start, so that the plugins can find them.
+    synthetic_flight flight;
+    if (!trace.replay_path.empty())
+    {
+        auto start_replay = (SimStartReplay)get_export(xplm_handle, "SimStartReplay");
+        auto recorded_frames = start_replay(trace.replay_path.c_str(), 1);
+        if (recorded_frames == 0)
+        {
+            cout << "Failed to open the trace file " << trace.replay_path << "." << endl;
+            return 1;
+        }
+        printf("replay=%s recorded_frames=%d\n", trace.replay_path.c_str(), recorded_frames);
+    }
+    else if (!trace.record_path.empty())
+    {
+        flight.define(xplm_handle);
+    }
+
+    std::vector<plugin> plugins;
+    for (auto& path : discover_plugins(plugins_folder))
+    {
+        plugin p {};
+        p.id = (int)plugins.size() + 1;
+        p.path = path;
+        p.name = path.stem().u8string();
+        register_plugin(p.id, path.u8string().c_str());
+        plugins.push_back(p);
+    }
+    if (plugins.empty())
+    {
+        cout << "No plugins found." << endl;
+        return 1;
+    }
+
+    int result = 0;
+    auto startup_begin = clock_type::now();
+    for (auto& p : plugins)
+    {
+        auto begin = clock_type::now();
+        set_current_plugin(p.id);
+#if defined(WINDOWS)
+        AddDllDirectory(p.path.parent_path().c_str());
 #endif
-    auto plugin_handle = load_library(sample_plugin_path.c_str());
-    auto plugin_start = (XPluginStart)get_export(plugin_handle, "XPluginStart");
-    char name[256], sig[256], desc[256];
-    if (!plugin_start(name, sig, desc))
+        auto handle = load_library(p.path.c_str());
+        p.start = (XPluginStart)get_export(handle, "XPluginStart");
+        p.stop = (XPluginStop)get_export(handle, "XPluginStop");
+        p.enable = (XPluginEnable)get_export(handle, "XPluginEnable");
+        p.disable = (XPluginDisable)get_export(handle, "XPluginDisable");
+        p.receive_message = (XPluginReceiveMessage)get_export(handle, "XPluginReceiveMessage");
+
+        char name[256] = {}, sig[256] = {}, desc[256] = {};
+        p.started = p.start(name, sig, desc) != 0;
+        auto start_ms = elapsed_ms(begin);
+        if (!p.started)
+        {
+            cout << "Failed to start plugin " << p.path.u8string() << "." << endl;
+            result = 1;
+            continue;
+        }
+        p.name = name;
+        set_plugin_info(p.id, name, sig, desc);
+
+        begin = clock_type::now();
+        p.enabled = p.enable() != 0;
+        auto enable_ms = elapsed_ms(begin);
+        if (!p.enabled)
+        {
+            cout << "Failed to enable plugin " << p.name << "." << endl;
+            result = 1;
+        }
+        printf("plugin=%d name=%s start=%.2fms enable=%.2fms\n", p.id, p.name.c_str(), start_ms, enable_ms);
+    }
+    startup_ms = elapsed_ms(startup_begin);
+
+    if (frames > 0 && !trace.record_path.empty())
+    {
+        auto start_recording = (SimStartRecording)get_export(xplm_handle, "SimStartRecording");
+        auto stop_recording = (SimStopRecording)get_export(xplm_handle, "SimStopRecording");
+        start_recording(trace.record_path.c_str());
+        run_frames(xplm_handle, plugins, frames, &flight);
+        if (!stop_recording())
+        {
+            cout << "Failed to write the trace file " << trace.record_path << "." << endl;
+            result = 1;
+        }
+        else
+        {
+            printf("record=%s size=%llu\n", trace.record_path.c_str(), (unsigned long long)fs::file_size(fs::u8path(trace.record_path)));
+        }
+    }
+    else if (frames > 0)
+    {
+        run_frames(xplm_handle, plugins, frames);
+    }
+
+    auto send_message = [&](int message, void* param)
+    {
+        for (auto& p : plugins)
+        {
+            if (!p.enabled)
+                continue;
+
+            set_current_plugin(p.id);
+            p.receive_message(0, message, param);
+        }
+    };
+    if (script)
+    {
+        script(send_message);
+    }
+    send_message(42, (void*)0xDEADBEEFDEADBEEF);
+
+    // The plugins are disabled and stopped in the reverse order, like in X-Plane.
+    for (auto p = plugins.rbegin(); p != plugins.rend(); ++p)
+    {
+        set_current_plugin(p->id);
+        if (p->enabled)
+        {
+            p->disable();
+        }
+        if (p->started)
+        {
+            p->stop();
+        }
+    }
+
+    if (!trace.replay_path.empty())
+    {
+        ((SimStopReplay)get_export(xplm_handle, "SimStopReplay"))();
+    }
+    return result;
+}
+
+// The runtime can be initialized only once per process, so each startup is measured in a child process.
+std::vector<double> measure_startup(const fs::path& sim_path, int runs)
+{
+    std::vector<double> results;
+    auto command = STR("\"") + sim_path.native() + STR("\" --measure-startup");
+    for (int i = 0; i < runs; i++)
+    {
+        auto pipe = popen(command.c_str(), POPEN_READ);
+        if (pipe == nullptr)
+            continue;
+
+        char line[1024];
+        double startup_ms;
+        while (fgets(line, sizeof(line), pipe) != nullptr)
+        {
+            if (sscanf(line, "startup_ms=%lf", &startup_ms) == 1)
+            {
+                results.push_back(startup_ms);
+            }
+        }
+        pclose(pipe);
+    }
+    std::sort(results.begin(), results.end());
+    return results;
+}
+
+void print_startup_statistics(const char* mode, const std::vector<double>& results)
+{
+    if (results.empty())
+    {
+        printf("%-4s no successful runs\n", mode);
+        return;
+    }
+    printf("%-4s runs=%zu min=%.2fms median=%.2fms max=%.2fms\n",
+        mode, results.size(), results.front(), results[results.size() / 2], results.back());
+}
+
+// Compares the plugin startup time with ReadyToRun code disabled and enabled.
+// The managed assemblies must be published with XPHOST_READY_TO_RUN=ON for the comparison to be meaningful.
+int run_startup_benchmark(const fs::path& sim_path, int runs)
+{
+    set_environment_variable(STR("DOTNET_ReadyToRun").c_str(), STR("0").c_str());
+    set_environment_variable(STR("COMPlus_ReadyToRun").c_str(), STR("0").c_str());
+    auto jit = measure_startup(sim_path, runs);
+
+    set_environment_variable(STR("DOTNET_ReadyToRun").c_str(), STR("1").c_str());
+    set_environment_variable(STR("COMPlus_ReadyToRun").c_str(), STR("1").c_str());
+    auto r2r = measure_startup(sim_path, runs);
+
+    print_startup_statistics("JIT", jit);
+    print_startup_statistics("R2R", r2r);
+    if (!jit.empty() && !r2r.empty())
+    {
+        printf("R2R speedup: %.2fx\n", jit[jit.size() / 2] / r2r[r2r.size() / 2]);
+    }
+    return jit.empty() || r2r.empty() ? 1 : 0;
+}
+
+// The benchmark datarefs, which are also read by the sample plugin when XP_SAMPLE_DATAREF_BENCHMARK is set.
+#define BENCHMARK_INT_DATAREF "sim/benchmark/int"
+#define BENCHMARK_FLOAT_ARRAY_DATAREF "sim/benchmark/float_array"
+#define BENCHMARK_FLOAT_ARRAY_LENGTH 64
+
+template <typename TFunc>
+void print_operation_time(const char* operation, int iterations, TFunc func)
+{
+    auto begin = clock_type::now();
+    for (int i = 0; i < iterations; i++)
     {
-        cout << "Failed to start plugin." << endl;
+        func(i);
+    }
+    auto ns = elapsed_ms(begin) * 1e6 / iterations;
+    printf("%-24s %8.2fns/op %10.2fMops/s\n", operation, ns, 1e3 / ns);
+}
+
+// Measures the cost of the native dataref calls, and then the cost of the same calls made from the sample plugin,
+// which prints its results to the log. The difference is the per-call overhead of the managed wrappers.
+int run_dataref_benchmark(const fs::path& startup_folder, int iterations)
+{
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
+    auto define_dataref = (SimDefineDataRef)get_export(xplm_handle, "SimDefineDataRef");
+    auto find_dataref = (XPLMFindDataRef)get_export(xplm_handle, "XPLMFindDataRef");
+    auto get_datai = (XPLMGetDatai)get_export(xplm_handle, "XPLMGetDatai");
+    auto set_datai = (XPLMSetDatai)get_export(xplm_handle, "XPLMSetDatai");
+    auto get_datavf = (XPLMGetDatavf)get_export(xplm_handle, "XPLMGetDatavf");
+
+    // xplmType_Int = 1, xplmType_FloatArray = 8
+    auto int_ref = define_dataref(BENCHMARK_INT_DATAREF, 1, 1, 1);
+    auto array_ref = define_dataref(BENCHMARK_FLOAT_ARRAY_DATAREF, 8, BENCHMARK_FLOAT_ARRAY_LENGTH, 1);
+
+    volatile int sink = 0;
+    float values[BENCHMARK_FLOAT_ARRAY_LENGTH];
+    printf("Native, %d iterations:\n", iterations);
+    print_operation_time("XPLMFindDataRef", iterations, [&](int) { sink = find_dataref(BENCHMARK_INT_DATAREF) != nullptr; });
+    print_operation_time("XPLMGetDatai", iterations, [&](int) { sink = get_datai(int_ref); });
+    print_operation_time("XPLMSetDatai", iterations, [&](int i) { set_datai(int_ref, i); });
+    print_operation_time("XPLMGetDatavf[64]", iterations, [&](int) { sink = get_datavf(array_ref, values, 0, BENCHMARK_FLOAT_ARRAY_LENGTH); });
+
+    printf("Managed:\n");
+    set_environment_variable(STR("XP_SAMPLE_DATAREF_BENCHMARK").c_str(), fs::path(std::to_string(iterations)).c_str());
+    double startup_ms = 0;
+    return run_plugins(startup_folder, startup_ms);
+}
+
+// The datarefs and the messages of the dataref cache test, which the sample plugin runs when XP_SAMPLE_DATAREF_CACHE_TEST is set,
+// see DataRefCacheTest.cs.
+#define CACHE_TEST_RESULT_DATAREF "sim/test/dataref_cache/result"
+#define CACHE_TEST_FOUND_DATAREF "sim/test/dataref_cache/found"
+#define CACHE_TEST_ADDED_DATAREF "sim/test/dataref_cache/added"
+#define CACHE_TEST_CHECK_MESSAGE 0x7E570000
+// XPLM_MSG_DATAREFS_ADDED of the XPLM400 SDK.
+#define XPLM_MSG_DATAREFS_ADDED 114
+
+// Checks the dataref cache of xphost through the sample plugin: a found dataref, a dataref which is not found,
+// and a dataref which is added later, whose cached miss must only be dropped by XPLM_MSG_DATAREFS_ADDED.
+int run_dataref_cache_test(const fs::path& startup_folder)
+{
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
+    auto define_dataref = (SimDefineDataRef)get_export(xplm_handle, "SimDefineDataRef");
+    auto get_datai = (XPLMGetDatai)get_export(xplm_handle, "XPLMGetDatai");
+
+    // xplmType_Int = 1
+    auto result_ref = define_dataref(CACHE_TEST_RESULT_DATAREF, 1, 1, 1);
+    define_dataref(CACHE_TEST_FOUND_DATAREF, 1, 1, 1);
+
+    set_environment_variable(STR("XP_SAMPLE_DATAREF_CACHE_TEST").c_str(), STR("1").c_str());
+    double startup_ms = 0;
+    auto result = run_plugins(startup_folder, startup_ms, 0, {}, [&](const send_message_function& send_message)
+    {
+        // The first message tells xphost that the misses can be cached.
+        send_message(XPLM_MSG_DATAREFS_ADDED, nullptr);
+        define_dataref(CACHE_TEST_ADDED_DATAREF, 1, 1, 1);
+        send_message(CACHE_TEST_CHECK_MESSAGE, nullptr);
+        send_message(XPLM_MSG_DATAREFS_ADDED, nullptr);
+    });
+
+    // The sample plugin sets the result to 1 if every check has passed, and to -1 otherwise.
+    auto passed = get_datai(result_ref) == 1;
+    printf("dataref_cache_test=%s\n", passed ? "passed" : "failed");
+    return result != 0 || !passed ? 1 : 0;
+}
+
+// Measures the navaid queries an FMS runs every frame against a navaid file: the nearest navaid of some types,
+// the nearest navaid on a frequency, and the lookup of an ID. The positions are pseudo-random but the same in every run.
+int run_navaid_benchmark(const fs::path& startup_folder, const fs::path& nav_data_path, int iterations)
+{
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
+    auto load_nav_data = (SimLoadNavData)get_export(xplm_handle, "SimLoadNavData");
+    auto find_nav_aid = (XPLMFindNavAid)get_export(xplm_handle, "XPLMFindNavAid");
+    auto get_nav_aid_info = (XPLMGetNavAidInfo)get_export(xplm_handle, "XPLMGetNavAidInfo");
+
+    auto begin = clock_type::now();
+    auto count = load_nav_data(nav_data_path.u8string().c_str());
+    if (count < 0)
+    {
+        cout << "Failed to load " << nav_data_path.u8string() << "." << endl;
         return 1;
     }
-    auto plugin_enable = (XPluginEnable)get_export(plugin_handle, "XPluginEnable");
-    if (!plugin_enable())
+    printf("navaids=%d load=%.1fms\n", count, elapsed_ms(begin));
+    if (count == 0)
+    {
+        cout << "No navaids in " << nav_data_path.u8string() << "." << endl;
+        return 1;
+    }
+
+    const int position_count = 4096;
+    std::vector<std::pair<float, float>> positions;
+    unsigned int seed = 12345;
+    auto next_random = [&] { seed = seed * 1103515245 + 12345; return (seed >> 8) / (float)(1 << 24); };
+    for (int i = 0; i < position_count; i++)
+    {
+        positions.emplace_back(next_random() * 140 - 70, next_random() * 360 - 180);
+    }
+
+    // Take an ID and a frequency from the data, so that the lookups succeed.
+    char id[32] = {}, name[256] = {};
+    int frequency = 0;
+    get_nav_aid_info(count / 2, nullptr, nullptr, nullptr, nullptr, &frequency, nullptr, id, name, nullptr);
+
+    // xplm_Nav_NDB | xplm_Nav_VOR = 6, xplm_Nav_DME = 1024, all the navaid types = 4095
+    volatile int sink = 0;
+    printf("%d iterations:\n", iterations);
+    print_operation_time("nearest VOR/NDB", iterations, [&](int i) {
+        auto& p = positions[i % position_count];
+        sink = find_nav_aid(nullptr, nullptr, &p.first, &p.second, nullptr, 6);
+    });
+    print_operation_time("nearest DME", iterations, [&](int i) {
+        auto& p = positions[i % position_count];
+        sink = find_nav_aid(nullptr, nullptr, &p.first, &p.second, nullptr, 1024);
+    });
+    print_operation_time("nearest on frequency", iterations, [&](int i) {
+        auto& p = positions[i % position_count];
+        sink = find_nav_aid(nullptr, nullptr, &p.first, &p.second, &frequency, 4095);
+    });
+    print_operation_time("find by ID", iterations, [&](int) { sink = find_nav_aid(nullptr, id, nullptr, nullptr, nullptr, 4095); });
+    print_operation_time("XPLMGetNavAidInfo", iterations, [&](int i) {
+        float lat, lon;
+        get_nav_aid_info(i % count, nullptr, &lat, &lon, nullptr, nullptr, nullptr, id, nullptr, nullptr);
+        sink = (int)lat;
+    });
+    return 0;
+}
+
+// Mirrors XPLMProbeInfo_t.
+struct probe_info
+{
+    int struct_size;
+    float location[3];
+    float normal[3];
+    float velocity[3];
+    int is_wet;
+};
+
+// Writes a tile set of 2 x 2 tiles of rolling hills around 47N 8E, which the probe benchmark uses
+// when it is not given a tile set. The layout is the one read by SimLoadTerrain.
+bool write_synthetic_terrain(const fs::path& path, int samples)
+{
+    struct { char magic[4]; uint32_t version, tile_count, reserved; } header { { 'X', 'P', 'H', 'F' }, 1, 4, 0 };
+    struct entry { int32_t latitude, longitude; uint32_t samples, reserved; uint64_t offset; };
+
+    auto file = fopen(path.u8string().c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    fwrite(&header, sizeof(header), 1, file);
+    auto offset = sizeof(header) + 4 * sizeof(entry);
+    for (int i = 0; i < 4; i++)
+    {
+        entry e { 46 + i / 2, 7 + i % 2, (uint32_t)samples, 0, offset };
+        fwrite(&e, sizeof(e), 1, file);
+        offset += (size_t)samples * samples * sizeof(float);
+    }
+
+    std::vector<float> heights((size_t)samples * samples);
+    for (int i = 0; i < 4; i++)
+    {
+        for (int row = 0; row < samples; row++)
+        {
+            for (int column = 0; column < samples; column++)
+            {
+                auto lat = 46 + i / 2 + row / (double)(samples - 1);
+                auto lon = 7 + i % 2 + column / (double)(samples - 1);
+                heights[(size_t)row * samples + column] = (float)(600 + 400 * sin(lat * 40) * cos(lon * 30));
+            }
+        }
+        fwrite(heights.data(), sizeof(float), heights.size(), file);
+    }
+    return fclose(file) == 0;
+}
+
+// Measures the terrain probes a terrain-following plugin makes every frame: a few hundred points probed one by one
+// with XPLMProbeTerrainXYZ, and the same points probed at once with SimProbeTerrainBatch.
+int run_probe_benchmark(const fs::path& startup_folder, fs::path terrain_path, int iterations)
+{
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
+    auto load_terrain = (SimLoadTerrain)get_export(xplm_handle, "SimLoadTerrain");
+    auto create_probe = (XPLMCreateProbe)get_export(xplm_handle, "XPLMCreateProbe");
+    auto destroy_probe = (XPLMDestroyProbe)get_export(xplm_handle, "XPLMDestroyProbe");
+    auto probe_terrain = (XPLMProbeTerrainXYZ)get_export(xplm_handle, "XPLMProbeTerrainXYZ");
+    auto probe_terrain_batch = (SimProbeTerrainBatch)get_export(xplm_handle, "SimProbeTerrainBatch");
+
+    if (terrain_path.empty())
+    {
+        terrain_path = fs::temp_directory_path() / STR("sim_probe_benchmark.xphf");
+        write_synthetic_terrain(terrain_path, 1201);
+    }
+
+    auto begin = clock_type::now();
+    auto tiles = load_terrain(terrain_path.u8string().c_str());
+    if (tiles <= 0)
     {
-        cout << "Failed to enable plugin." << endl;
+        cout << "Failed to load " << terrain_path.u8string() << "." << endl;
         return 1;
     }
-    auto plugin_receive_message = (XPluginReceiveMessage)get_export(plugin_handle, "XPluginReceiveMessage");
-    plugin_receive_message(0, 42, (void*)0xDEADBEEFDEADBEEF);
-    auto plugin_disable = (XPluginDisable)get_export(plugin_handle, "XPluginDisable");
-    plugin_disable();
-    auto plugin_stop = (XPluginStop)get_export(plugin_handle, "XPluginStop");
-    plugin_stop();
+    printf("tiles=%d load=%.1fms\n", tiles, elapsed_ms(begin));
 
+    // The points are spread over 20 km around the local reference point, which is the center of the first tile.
+    const int point_count = 256;
+    std::vector<float> points;
+    unsigned int seed = 12345;
+    auto next_random = [&] { seed = seed * 1103515245 + 12345; return (seed >> 8) / (float)(1 << 24); };
+    for (int i = 0; i < point_count; i++)
+    {
+        points.push_back(next_random() * 20000 - 10000);
+        points.push_back(3000);
+        points.push_back(next_random() * 20000 - 10000);
+    }
+
+    // xplm_ProbeY = 0, xplm_ProbeHitTerrain = 0
+    auto probe = create_probe(0);
+    probe_info info {};
+    info.struct_size = sizeof(probe_info);
+    std::vector<probe_info> infos(point_count, info);
+    std::vector<int> results(point_count);
+    volatile int sink = 0;
+    printf("%d iterations of %d points:\n", iterations, point_count);
+    print_operation_time("XPLMProbeTerrainXYZ", iterations, [&](int) {
+        for (int i = 0; i < point_count; i++)
+        {
+            sink = probe_terrain(probe, points[i * 3], points[i * 3 + 1], points[i * 3 + 2], &infos[i]);
+        }
+    });
+    print_operation_time("SimProbeTerrainBatch", iterations, [&](int) {
+        sink = probe_terrain_batch(probe, points.data(), point_count, infos.data(), results.data());
+    });
+    destroy_probe(probe);
     return 0;
-}
\ No newline at end of file
+}
+
+// Mirrors XPLMDrawInfo_t.
+struct draw_info
+{
+    int struct_size;
+    float x, y, z;
+    float pitch, heading, roll;
+};
+
+// Measures the per-frame position updates of many instances, such as the AI traffic and the ground vehicles:
+// one XPLMInstanceSetPosition call per instance, and one SimInstanceSetPositions call for all of them,
+// which is what the batch of xphost turns the managed updates into.
+int run_instance_benchmark(const fs::path& startup_folder, int instance_count, int frames)
+{
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
+    auto load_object = (XPLMLoadObject)get_export(xplm_handle, "XPLMLoadObject");
+    auto unload_object = (XPLMUnloadObject)get_export(xplm_handle, "XPLMUnloadObject");
+    auto create_instance = (XPLMCreateInstance)get_export(xplm_handle, "XPLMCreateInstance");
+    auto destroy_instance = (XPLMDestroyInstance)get_export(xplm_handle, "XPLMDestroyInstance");
+    auto set_position = (XPLMInstanceSetPosition)get_export(xplm_handle, "XPLMInstanceSetPosition");
+    auto set_positions = (SimInstanceSetPositions)get_export(xplm_handle, "SimInstanceSetPositions");
+    auto get_position = (SimGetInstancePosition)get_export(xplm_handle, "SimGetInstancePosition");
+
+    // Each instance animates its wheels, its beacon and its rudder.
+    const int dataref_count = 4;
+    const char* datarefs[dataref_count + 1] =
+    {
+        "sim/benchmark/instance/wheel_rotation",
+        "sim/benchmark/instance/wheel_steer",
+        "sim/benchmark/instance/beacon",
+        "sim/benchmark/instance/rudder",
+        nullptr
+    };
+    auto object = load_object("Resources/default scenery/airport scenery/Aircraft/General_Aviation/Cessna_172.obj");
+    std::vector<void*> instances;
+    std::vector<int> data_offsets;
+    for (int i = 0; i < instance_count; i++)
+    {
+        instances.push_back(create_instance(object, datarefs));
+        data_offsets.push_back(i * dataref_count);
+    }
+
+    std::vector<draw_info> positions(instance_count);
+    std::vector<float> data((size_t)instance_count * dataref_count);
+    auto update = [&](int frame) {
+        for (int i = 0; i < instance_count; i++)
+        {
+            positions[i] = draw_info { sizeof(draw_info), i * 10.0f, 0, frame * 0.5f, 0, (float)(frame % 360), 0 };
+            for (int j = 0; j < dataref_count; j++)
+            {
+                data[(size_t)i * dataref_count + j] = (float)(frame + j);
+            }
+        }
+    };
+
+    printf("%d frames of %d instances:\n", frames, instance_count);
+    update(0);
+    print_operation_time("XPLMInstanceSetPosition", frames, [&](int /*frame*/) {
+        for (int i = 0; i < instance_count; i++)
+        {
+            set_position(instances[i], &positions[i], &data[(size_t)i * dataref_count]);
+        }
+    });
+    print_operation_time("SimInstanceSetPositions", frames, [&](int /*frame*/) {
+        set_positions(instances.data(), instance_count, positions.data(), data.data(), data_offsets.data());
+    });
+
+    // Check that the batch has set the values of the last instance.
+    update(1);
+    set_positions(instances.data(), instance_count, positions.data(), data.data(), data_offsets.data());
+    draw_info last;
+    float last_data[dataref_count];
+    get_position(instances.back(), &last, last_data, dataref_count);
+    int result = last.z == positions.back().z && last_data[dataref_count - 1] == data.back() ? 0 : 1;
+
+    for (auto instance : instances)
+    {
+        destroy_instance(instance);
+    }
+    unload_object(object);
+    return result;
+}
+
+// The benchmark command, which the sample plugin also handles and fires when XP_SAMPLE_COMMAND_BENCHMARK is set.
+#define BENCHMARK_COMMAND "sim/benchmark/command"
+
+static int count_command(void* /*command*/, int /*phase*/, void* refcon)
+{
+    (*(long long*)refcon)++;
+    return 1;
+}
+
+// Measures the dispatch of a command to native handlers, fired one by one with XPLMCommandOnce and in bulk with SimFireCommand,
+// and then the same from the sample plugin, which prints its results to the log. The difference is the cost of the managed
+// handlers and wrappers, and the plugin also reports the bytes the managed code allocates per command.
+int run_command_benchmark(const fs::path& startup_folder, int iterations)
+{
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
+    auto create_command = (XPLMCreateCommand)get_export(xplm_handle, "XPLMCreateCommand");
+    auto register_handler = (XPLMRegisterCommandHandler)get_export(xplm_handle, "XPLMRegisterCommandHandler");
+    auto command_once = (XPLMCommandOnce)get_export(xplm_handle, "XPLMCommandOnce");
+    auto fire_command = (SimFireCommand)get_export(xplm_handle, "SimFireCommand");
+
+    auto command = create_command(BENCHMARK_COMMAND, "The command of the benchmark");
+    long long before_calls = 0, after_calls = 0;
+    register_handler(command, count_command, 1, &before_calls);
+    register_handler(command, count_command, 0, &after_calls);
+
+    printf("Native, %d iterations:\n", iterations);
+    print_operation_time("XPLMCommandOnce", iterations, [&](int) { command_once(command); });
+    auto begin = clock_type::now();
+    fire_command(command, iterations);
+    auto ns = elapsed_ms(begin) * 1e6 / iterations;
+    printf("%-24s %8.2fns/op %10.2fMops/s\n", "SimFireCommand", ns, 1e3 / ns);
+    // Each command is a begin and an end.
+    if (before_calls != 4LL * iterations || after_calls != 4LL * iterations)
+    {
+        printf("Unexpected handler calls: before=%lld after=%lld\n", before_calls, after_calls);
+        return 1;
+    }
+
+    printf("Managed:\n");
+    set_environment_variable(STR("XP_SAMPLE_COMMAND_BENCHMARK").c_str(), fs::path(std::to_string(iterations)).c_str());
+    double startup_ms = 0;
+    return run_plugins(startup_folder, startup_ms);
+}
+
+// Mirrors XPLMCreateWindow_t of XPLM301.
+struct create_window_params
+{
+    int struct_size;
+    int left, top, right, bottom;
+    int visible;
+    XPLMDrawWindow draw_window_func;
+    void* handle_mouse_click_func;
+    void* handle_key_func;
+    void* handle_cursor_func;
+    void* handle_mouse_wheel_func;
+    void* refcon;
+    int decorate_as_floating_window;
+    int layer;
+    void* handle_right_click_func;
+};
+
+static void count_draw(void* /*window*/, void* refcon)
+{
+    (*(long long*)refcon)++;
+}
+
+// Measures the drawing of a frame with the given number of windows, first with native draw functions, to get the cost
+// of the null renderer itself, and then with the windows of the sample plugin, which it creates when XP_SAMPLE_DRAW_WINDOWS
+// is set. The frames of the plugins report the time spent in the managed draw functions as the draw_window_func phase.
+int run_draw_benchmark(const fs::path& startup_folder, int window_count, int frames)
+{
+    auto xplm_handle = load_library(get_xplm_path(startup_folder).c_str());
+    auto draw_frame = (SimDrawFrame)get_export(xplm_handle, "SimDrawFrame");
+    auto create_window = (XPLMCreateWindowEx)get_export(xplm_handle, "XPLMCreateWindowEx");
+    auto destroy_window = (XPLMDestroyWindow)get_export(xplm_handle, "XPLMDestroyWindow");
+    auto bring_window_to_front = (XPLMBringWindowToFront)get_export(xplm_handle, "XPLMBringWindowToFront");
+    auto is_window_in_front = (XPLMIsWindowInFront)get_export(xplm_handle, "XPLMIsWindowInFront");
+
+    long long draws = 0;
+    std::vector<void*> windows;
+    for (int i = 0; i < window_count; i++)
+    {
+        create_window_params params {};
+        params.struct_size = sizeof(create_window_params);
+        params.left = 10 * i;
+        params.top = 500 + 10 * i;
+        params.right = 300 + 10 * i;
+        params.bottom = 10 * i;
+        params.visible = 1;
+        params.draw_window_func = count_draw;
+        params.refcon = &draws;
+        params.layer = 1;
+        windows.push_back(create_window(&params));
+    }
+
+    // The last created window is in front, until another one is brought to the front.
+    int result = 0;
+    if (window_count > 1)
+    {
+        bool created_in_front = is_window_in_front(windows.back()) && !is_window_in_front(windows.front());
+        bring_window_to_front(windows.front());
+        bool brought_to_front = is_window_in_front(windows.front()) && !is_window_in_front(windows.back());
+        if (!created_in_front || !brought_to_front)
+        {
+            printf("Unexpected z-order of the windows.\n");
+            result = 1;
+        }
+    }
+
+    printf("Native, %d frames of %d windows:\n", frames, window_count);
+    print_operation_time("SimDrawFrame", frames, [&](int) { draw_frame(); });
+    if (draws != (long long)frames * window_count)
+    {
+        printf("Unexpected draw calls: %lld\n", draws);
+        result = 1;
+    }
+
+    for (auto window : windows)
+    {
+        destroy_window(window);
+    }
+    if (result != 0)
+        return result;
+
+    printf("Managed:\n");
+    set_environment_variable(STR("XP_SAMPLE_DRAW_WINDOWS").c_str(), fs::path(std::to_string(window_count)).c_str());
+    double startup_ms = 0;
+    return run_plugins(startup_folder, startup_ms, frames);
+}
+
+// Reads the positive count in the argument at the index, or the default count if the argument is missing.
+// Prints a usage error and returns false if the argument is not a positive integer.
+template <typename TChar>
+static bool read_count_argument(int argc, TChar* argv[], int index, int default_count, int& count)
+{
+    if (index >= argc)
+    {
+        count = default_count;
+        return true;
+    }
+
+    auto text = fs::path(argv[index]).u8string();
+    char* end = nullptr;
+    errno = 0;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != 0 || errno == ERANGE || parsed <= 0 || parsed > INT_MAX)
+    {
+        printf("%s: expected a positive integer instead of '%s'.\n", fs::path(argv[1]).u8string().c_str(), text.c_str());
+        return false;
+    }
+    count = (int)parsed;
+    return true;
+}
+
+#if defined(WINDOWS)
+int __cdecl wmain(int argc, wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+    auto sim_path = fs::canonical(fs::path(argv[0]));
+    auto startup_folder = sim_path.parent_path();
+    auto mode = argc > 1 ? fs::path(argv[1]).u8string() : std::string();
+
+    if (mode == "--startup-benchmark")
+    {
+        int runs;
+        if (!read_count_argument(argc, argv, 2, 5, runs))
+            return 1;
+        return run_startup_benchmark(sim_path, runs);
+    }
+
+    if (mode == "--dataref-benchmark")
+    {
+        int iterations;
+        if (!read_count_argument(argc, argv, 2, 10000000, iterations))
+            return 1;
+        return run_dataref_benchmark(startup_folder, iterations);
+    }
+
+    if (mode == "--dataref-cache-test")
+    {
+        return run_dataref_cache_test(startup_folder);
+    }
+
+    if (mode == "--navaid-benchmark")
+    {
+        auto nav_data_path = argc > 2 ? fs::path(argv[2]) : get_nav_data_path(startup_folder);
+        int iterations;
+        if (!read_count_argument(argc, argv, 3, 1000000, iterations))
+            return 1;
+        return run_navaid_benchmark(startup_folder, nav_data_path, iterations);
+    }
+
+    if (mode == "--probe-benchmark")
+    {
+        auto terrain_path = argc > 2 ? fs::path(argv[2]) : fs::path();
+        int iterations;
+        if (!read_count_argument(argc, argv, 3, 10000, iterations))
+            return 1;
+        return run_probe_benchmark(startup_folder, terrain_path, iterations);
+    }
+
+    if (mode == "--command-benchmark")
+    {
+        int iterations;
+        if (!read_count_argument(argc, argv, 2, 1000000, iterations))
+            return 1;
+        return run_command_benchmark(startup_folder, iterations);
+    }
+
+    if (mode == "--instance-benchmark")
+    {
+        int instance_count;
+        if (!read_count_argument(argc, argv, 2, 2000, instance_count))
+            return 1;
+        int frames;
+        if (!read_count_argument(argc, argv, 3, 10000, frames))
+            return 1;
+        return run_instance_benchmark(startup_folder, instance_count, frames);
+    }
+
+    if (mode == "--draw-benchmark")
+    {
+        int window_count;
+        if (!read_count_argument(argc, argv, 2, 20, window_count))
+            return 1;
+        int frames;
+        if (!read_count_argument(argc, argv, 3, 100000, frames))
+            return 1;
+        return run_draw_benchmark(startup_folder, window_count, frames);
+    }
+
+    int frames = 0;
+    trace_options trace;
+    if (mode == "--frames")
+    {
+        if (!read_count_argument(argc, argv, 2, 100000, frames))
+            return 1;
+        // --frames N [--record <file> | --replay <file>]
+        for (int i = 3; i + 1 < argc; i += 2)
+        {
+            auto option = fs::path(argv[i]).u8string();
+            auto value = fs::path(argv[i + 1]).u8string();
+            if (option == "--record")
+            {
+                trace.record_path = value;
+            }
+            else if (option == "--replay")
+            {
+                trace.replay_path = value;
+            }
+        }
+    }
+
+    double startup_ms = 0;
+    int result = run_plugins(startup_folder, startup_ms, frames, trace);
+    if (result == 0 && mode == "--measure-startup")
+    {
+        printf("startup_ms=%f\n", startup_ms);
+    }
+    return result;
+}
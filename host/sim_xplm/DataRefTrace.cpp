@@ -0,0 +1,484 @@
+#include "Sim.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Records the values of the simulator-owned datarefs per frame, and replays them.
+//
+// The trace file is columnar: a header and a directory are followed by one column per dataref,
+// which holds only the frames where its value has changed. All integers are LEB128 varints.
+//
+//   header:    "XPDT", version, frame count, dataref count (uint32 each)
+//   directory: per dataref: type, length (uint32), column offset, column size (uint64),
+//              name length (uint16), name
+//   column:    per change: frame delta from the previous change, then the value:
+//              int, float, double:   zigzag delta of the value bits from the previous value
+//              int and float arrays: changed element count, then per element the index delta
+//                                    and the zigzag delta of the element bits
+//              data:                 the whole value
+//
+// Values start at zero, so the first change of a column is the delta from zero. Similar floats
+// have similar bit patterns, so the deltas of the bits stay small.
+
+static const char TRACE_MAGIC[4] = { 'X', 'P', 'D', 'T' };
+static const uint32_t TRACE_VERSION = 1;
+
+static void WriteVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// Returns false if the varint runs past the end, or has more than 64 bits.
+static bool ReadVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7)
+    {
+        auto byte = *in++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+static uint64_t ZigZag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// The value bits of an element, which the deltas are computed on.
+static int64_t GetElementBits(const void* storage, XPLMDataTypeID type, int index)
+{
+    switch (type)
+    {
+    case xplmType_Double:
+        int64_t bits64;
+        memcpy(&bits64, (const double*)storage + index, sizeof(bits64));
+        return bits64;
+    case xplmType_Data:
+        return ((const uint8_t*)storage)[index];
+    default:
+        // int and float elements have 4 bytes
+        int32_t bits32;
+        memcpy(&bits32, (const int32_t*)storage + index, sizeof(bits32));
+        return bits32;
+    }
+}
+
+static void SetElementBits(void* storage, XPLMDataTypeID type, int index, int64_t bits)
+{
+    switch (type)
+    {
+    case xplmType_Double:
+        memcpy((double*)storage + index, &bits, sizeof(bits));
+        break;
+    case xplmType_Data:
+        ((uint8_t*)storage)[index] = (uint8_t)bits;
+        break;
+    default:
+        auto bits32 = (int32_t)bits;
+        memcpy((int32_t*)storage + index, &bits32, sizeof(bits32));
+        break;
+    }
+}
+
+static int GetElementCount(XPLMDataTypeID type, int length)
+{
+    return type == xplmType_Int || type == xplmType_Float || type == xplmType_Double ? 1 : length;
+}
+
+struct RecordedColumn
+{
+    SimDataRefInfo info;
+    std::vector<int64_t> previous;
+    int previousFrame = -1;
+    std::vector<uint8_t> data;
+};
+
+struct Recording
+{
+    std::string path;
+    int frame = 0;
+    std::vector<RecordedColumn> columns;
+};
+
+static Recording* recording = nullptr;
+
+static void RecordFrame(Recording& r)
+{
+    static std::vector<std::pair<int, int64_t>> changes;
+    for (auto& column : r.columns)
+    {
+        auto storage = SimGetDataRefStorage(column.info.ref);
+        auto type = column.info.type;
+        auto count = (int)column.previous.size();
+        changes.clear();
+        for (int i = 0; i < count; i++)
+        {
+            auto bits = GetElementBits(storage, type, i);
+            if (bits != column.previous[i])
+            {
+                changes.emplace_back(i, bits);
+            }
+        }
+        if (changes.empty())
+            continue;
+
+        WriteVarint(column.data, (uint64_t)(r.frame - column.previousFrame));
+        column.previousFrame = r.frame;
+        if (type == xplmType_Data)
+        {
+            WriteVarint(column.data, (uint64_t)count);
+            for (int i = 0; i < count; i++)
+            {
+                column.data.push_back((uint8_t)GetElementBits(storage, type, i));
+            }
+        }
+        else if (type == xplmType_IntArray || type == xplmType_FloatArray)
+        {
+            WriteVarint(column.data, changes.size());
+            int previousIndex = -1;
+            for (auto& [index, bits] : changes)
+            {
+                WriteVarint(column.data, (uint64_t)(index - previousIndex));
+                WriteVarint(column.data, ZigZag(bits - column.previous[index]));
+                previousIndex = index;
+            }
+        }
+        else
+        {
+            WriteVarint(column.data, ZigZag(changes[0].second - column.previous[0]));
+        }
+
+        for (auto& [index, bits] : changes)
+        {
+            column.previous[index] = bits;
+        }
+    }
+    r.frame++;
+}
+
+static bool WriteTrace(const Recording& r)
+{
+    auto file = fopen(r.path.c_str(), "wb");
+    if (file == nullptr)
+        return false;
+
+    auto write32 = [&](uint32_t value) { fwrite(&value, sizeof(value), 1, file); };
+    auto write64 = [&](uint64_t value) { fwrite(&value, sizeof(value), 1, file); };
+
+    fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file);
+    write32(TRACE_VERSION);
+    write32((uint32_t)r.frame);
+    write32((uint32_t)r.columns.size());
+
+    uint64_t directorySize = 0;
+    for (auto& column : r.columns)
+    {
+        directorySize += 4 + 4 + 8 + 8 + 2 + strlen(column.info.name);
+    }
+
+    uint64_t offset = sizeof(TRACE_MAGIC) + 3 * 4 + directorySize;
+    for (auto& column : r.columns)
+    {
+        auto nameLength = (uint16_t)strlen(column.info.name);
+        write32((uint32_t)column.info.type);
+        write32((uint32_t)column.info.length);
+        write64(offset);
+        write64(column.data.size());
+        fwrite(&nameLength, sizeof(nameLength), 1, file);
+        fwrite(column.info.name, 1, nameLength, file);
+        offset += column.data.size();
+    }
+
+    for (auto& column : r.columns)
+    {
+        fwrite(column.data.data(), 1, column.data.size(), file);
+    }
+    return fclose(file) == 0;
+}
+
+extern "C" XPLM_API int SimStartRecording(const char* path);
+extern "C" XPLM_API int SimStopRecording();
+
+// Starts recording the simulator-owned datarefs defined so far, at the end of every frame.
+int SimStartRecording(const char* path)
+{
+    if (recording != nullptr)
+        return 0;
+
+    recording = new Recording();
+    recording->path = path;
+    for (auto& info : SimGetOwnedDataRefs())
+    {
+        RecordedColumn column;
+        column.info = info;
+        column.previous.assign(GetElementCount(info.type, info.length), 0);
+        recording->columns.push_back(std::move(column));
+    }
+    return 1;
+}
+
+// Writes the trace file. Returns 1 on success.
+int SimStopRecording()
+{
+    if (recording == nullptr)
+        return 0;
+
+    auto written = WriteTrace(*recording);
+    delete recording;
+    recording = nullptr;
+    return written ? 1 : 0;
+}
+
+struct ReplayedColumn
+{
+    XPLMDataRef ref;
+    XPLMDataTypeID type;
+    // The number of the elements of the dataref, which may differ from the recorded length
+    // if the dataref was already defined.
+    int elementCount;
+    const uint8_t* begin;
+    const uint8_t* end;
+    const uint8_t* cursor;
+    // The frame of the next change, or -1 if there are no more changes.
+    int64_t nextFrame;
+    // Whether the dataref was writable before the replay, restored when the replay stops.
+    bool writable;
+};
+
+struct Replay
+{
+    MappedFile file;
+    uint32_t frameCount = 0;
+    int frame = 0;
+    bool loop = false;
+    std::vector<ReplayedColumn> columns;
+};
+
+static Replay* replay = nullptr;
+
+// Reads the frame of the next change, after the change of the frame.
+static void ReadNextFrame(ReplayedColumn& column, int64_t frame)
+{
+    uint64_t delta;
+    column.nextFrame = column.cursor < column.end && ReadVarint(column.cursor, column.end, delta) ? frame + (int64_t)delta : -1;
+}
+
+static void RewindColumn(ReplayedColumn& column)
+{
+    column.cursor = column.begin;
+    ReadNextFrame(column, -1);
+    auto storage = SimGetDataRefStorage(column.ref);
+    for (int i = 0; i < column.elementCount; i++)
+    {
+        SetElementBits(storage, column.type, i, 0);
+    }
+}
+
+// Applies the next change of the column to the dataref.
+// Returns false if the change runs past the end of the column or indexes past the end of the dataref.
+static bool ApplyChange(ReplayedColumn& column)
+{
+    auto storage = SimGetDataRefStorage(column.ref);
+    auto& in = column.cursor;
+    auto end = column.end;
+    if (column.type == xplmType_Data)
+    {
+        // The bytes past the length of the dataref are skipped.
+        uint64_t count;
+        if (!ReadVarint(in, end, count) || count > (uint64_t)(end - in))
+            return false;
+
+        auto stored = (int)std::min(count, (uint64_t)column.elementCount);
+        for (int i = 0; i < stored; i++)
+        {
+            SetElementBits(storage, column.type, i, in[i]);
+        }
+        in += count;
+    }
+    else if (column.type == xplmType_IntArray || column.type == xplmType_FloatArray)
+    {
+        uint64_t changes;
+        if (!ReadVarint(in, end, changes))
+            return false;
+
+        int64_t index = -1;
+        for (uint64_t i = 0; i < changes; i++)
+        {
+            uint64_t step, delta;
+            if (!ReadVarint(in, end, step) || !ReadVarint(in, end, delta) || step > (uint64_t)column.elementCount)
+                return false;
+
+            index += (int64_t)step;
+            if (index < 0 || index >= column.elementCount)
+                return false;
+            SetElementBits(storage, column.type, (int)index, GetElementBits(storage, column.type, (int)index) + UnZigZag(delta));
+        }
+    }
+    else
+    {
+        uint64_t delta;
+        if (!ReadVarint(in, end, delta))
+            return false;
+        SetElementBits(storage, column.type, 0, GetElementBits(storage, column.type, 0) + UnZigZag(delta));
+    }
+    return true;
+}
+
+static void ReplayColumn(ReplayedColumn& column, int frame)
+{
+    if (column.nextFrame != frame)
+        return;
+
+    // A corrupted column stops, and keeps the values replayed so far.
+    if (!ApplyChange(column))
+    {
+        column.nextFrame = -1;
+        return;
+    }
+    ReadNextFrame(column, frame);
+}
+
+extern "C" XPLM_API int SimStartReplay(const char* path, int loop);
+extern "C" XPLM_API void SimStopReplay();
+
+// Serves the recorded datarefs from the trace file, one recorded frame per simulated frame.
+// The datarefs are defined if necessary and are read-only for the plugins during the replay.
+// Returns the number of the recorded frames, or 0 if the file cannot be replayed.
+int SimStartReplay(const char* path, int loop)
+{
+    if (replay != nullptr)
+        return 0;
+
+    auto r = new Replay();
+    r->loop = loop != 0;
+    const size_t headerSize = sizeof(TRACE_MAGIC) + 3 * 4;
+    if (!r->file.open(path) || r->file.length() < headerSize || memcmp(r->file.begin(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0)
+    {
+        delete r;
+        return 0;
+    }
+
+    auto data = r->file.begin();
+    auto fileLength = (uint64_t)r->file.length();
+    auto in = data + sizeof(TRACE_MAGIC);
+    auto fits = [&](uint64_t size) { return size <= fileLength - (uint64_t)(in - data); };
+    auto read32 = [&]() { uint32_t value; memcpy(&value, in, sizeof(value)); in += sizeof(value); return value; };
+    auto read64 = [&]() { uint64_t value; memcpy(&value, in, sizeof(value)); in += sizeof(value); return value; };
+
+    auto version = read32();
+    r->frameCount = read32();
+    auto count = read32();
+    if (version != TRACE_VERSION)
+    {
+        delete r;
+        return 0;
+    }
+
+    // The file is rejected if the directory runs past its end, or a column lies outside of it.
+    const size_t entrySize = 2 * 4 + 2 * 8 + sizeof(uint16_t);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!fits(entrySize))
+        {
+            delete r;
+            return 0;
+        }
+
+        auto type = (XPLMDataTypeID)read32();
+        auto length = (int)read32();
+        auto offset = read64();
+        auto size = read64();
+        uint16_t nameLength;
+        memcpy(&nameLength, in, sizeof(nameLength));
+        in += sizeof(nameLength);
+        if (!fits(nameLength) || offset > fileLength || size > fileLength - offset)
+        {
+            delete r;
+            return 0;
+        }
+
+        std::string name((const char*)in, nameLength);
+        in += nameLength;
+
+        // The dataref may already be defined with another length, which the replay is bounded by.
+        auto ref = SimDefineDataRef(name.c_str(), type, length, 0);
+        int definedLength = 0;
+        if (ref == nullptr || SimGetDataRefStorage(ref, &definedLength) == nullptr)
+            continue;
+
+        ReplayedColumn column { ref, type, GetElementCount(type, definedLength), data + offset, data + offset + size, nullptr, -1, false };
+        r->columns.push_back(column);
+    }
+
+    for (auto& column : r->columns)
+    {
+        column.writable = SimSetDataRefWritable(column.ref, false);
+        RewindColumn(column);
+    }
+    replay = r;
+    return (int)r->frameCount;
+}
+
+void SimStopReplay()
+{
+    if (replay == nullptr)
+        return;
+
+    // The columns are restored in the reverse order, so that a dataref replayed by several columns gets its first state.
+    for (auto column = replay->columns.rbegin(); column != replay->columns.rend(); ++column)
+    {
+        SimSetDataRefWritable(column->ref, column->writable);
+    }
+    delete replay;
+    replay = nullptr;
+}
+
+void SimTraceBeginFrame()
+{
+    if (replay == nullptr)
+        return;
+
+    if (replay->frame >= (int)replay->frameCount)
+    {
+        // The values of the last frame are kept, unless the replay loops.
+        if (!replay->loop || replay->frameCount == 0)
+            return;
+
+        replay->frame = 0;
+        for (auto& column : replay->columns)
+        {
+            RewindColumn(column);
+        }
+    }
+
+    for (auto& column : replay->columns)
+    {
+        ReplayColumn(column, replay->frame);
+    }
+    replay->frame++;
+}
+
+void SimTraceEndFrame()
+{
+    if (recording != nullptr)
+    {
+        RecordFrame(*recording);
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if IBM
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A read-only memory mapping of a whole file.
+class MappedFile
+{
+private:
+#if IBM
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int file = -1;
+#endif
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path)
+    {
+#if IBM
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        size = (size_t)fileSize.QuadPart;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+            return false;
+
+        data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        file = ::open(path, O_RDONLY);
+        if (file < 0)
+            return false;
+
+        struct stat fileStat;
+        if (fstat(file, &fileStat) != 0)
+            return false;
+
+        size = (size_t)fileStat.st_size;
+        auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        data = address != MAP_FAILED ? (const uint8_t*)address : nullptr;
+#endif
+        return data != nullptr;
+    }
+
+    ~MappedFile()
+    {
+#if IBM
+        if (data != nullptr)
+            UnmapViewOfFile(data);
+        if (mapping != nullptr)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+#else
+        if (data != nullptr)
+            munmap((void*)data, size);
+        if (file >= 0)
+            close(file);
+#endif
+    }
+
+    const uint8_t* begin() const
+    {
+        return data;
+    }
+
+    size_t length() const
+    {
+        return size;
+    }
+};
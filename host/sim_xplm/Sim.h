@@ -0,0 +1,88 @@
+#pragma once
+
+#include <XPLMDefs.h>
+#include <XPLMDataAccess.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Internal services shared by the parts of sim_xplm.
+
+// Returns the plugin whose code is running, which the XPLM calls are attributed to.
+XPLMPluginID SimGetCurrentPlugin();
+
+// Makes the plugin current for the lifetime of the object, e.g. while one of its callbacks runs.
+class SimPluginScope
+{
+private:
+    XPLMPluginID previous;
+
+public:
+    explicit SimPluginScope(XPLMPluginID plugin);
+    ~SimPluginScope();
+
+    SimPluginScope(const SimPluginScope&) = delete;
+    SimPluginScope& operator=(const SimPluginScope&) = delete;
+};
+
+// Records the time a plugin has spent in a callback of the phase.
+// The phase must be a string literal, since the statistics are keyed by its address.
+void SimRecordTiming(XPLMPluginID plugin, const char* phase, int64_t nanoseconds);
+
+// Makes the plugin current and records the time spent in its callback for the lifetime of the object.
+class SimCallbackScope
+{
+private:
+    using clock = std::chrono::steady_clock;
+
+    SimPluginScope plugin_scope;
+    XPLMPluginID plugin;
+    const char* phase;
+    clock::time_point begin;
+
+public:
+    SimCallbackScope(XPLMPluginID plugin, const char* phase)
+        : plugin_scope(plugin), plugin(plugin), phase(phase), begin(clock::now())
+    {
+    }
+
+    ~SimCallbackScope()
+    {
+        SimRecordTiming(plugin, phase, std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - begin).count());
+    }
+};
+
+struct SimDataRefInfo
+{
+    XPLMDataRef ref;
+    const char* name;
+    XPLMDataTypeID type;
+    int length;
+};
+
+// Returns the datarefs defined by the simulator with SimDefineDataRef.
+std::vector<SimDataRefInfo> SimGetOwnedDataRefs();
+
+// Returns the built-in storage of a simulator-owned dataref: int, float, double or byte values depending on its type,
+// or null if the dataref is not owned by the simulator, and stores the number of the values in outLength.
+// The pointer is valid until the next dataref is defined or shared.
+void* SimGetDataRefStorage(XPLMDataRef ref, int* outLength = nullptr);
+
+// Sets whether the plugins may write the dataref, and returns whether they could.
+bool SimSetDataRefWritable(XPLMDataRef ref, bool writable);
+
+// Called by SimRunFrame around the flight loops, to replay and record the dataref trace, see DataRefTrace.cpp.
+void SimTraceBeginFrame();
+void SimTraceEndFrame();
+
+// Called by SimRunFrame before the flight loops, to send the continue phase to the held commands, see XPLMCommands.cpp.
+// Returns the number of the command handlers called.
+int SimContinueHeldCommands();
+
+// Called by SimDrawFrame in the window phase, to draw the visible windows back to front, see XPLMWindows.cpp.
+// Returns the number of the draw functions called.
+int SimDrawWindows();
+
+// Exported for the harness, see XPLMDataAccess.cpp.
+extern "C" XPLM_API XPLMDataRef SimDefineDataRef(const char* name, XPLMDataTypeID type, int length, int writable);
@@ -0,0 +1,53 @@
+#include "Sim.h"
+
+#include <vector>
+
+struct Timing
+{
+    XPLMPluginID plugin;
+    const char* phase;
+    int64_t calls;
+    int64_t totalNanoseconds;
+    int64_t maxNanoseconds;
+};
+
+// There are few plugins and phases, so a linear search by the phase address is the fastest lookup.
+static std::vector<Timing> timings;
+
+void SimRecordTiming(XPLMPluginID plugin, const char* phase, int64_t nanoseconds)
+{
+    for (auto& timing : timings)
+    {
+        if (timing.phase == phase && timing.plugin == plugin)
+        {
+            timing.calls++;
+            timing.totalNanoseconds += nanoseconds;
+            if (nanoseconds > timing.maxNanoseconds)
+            {
+                timing.maxNanoseconds = nanoseconds;
+            }
+            return;
+        }
+    }
+
+    timings.push_back(Timing { plugin, phase, 1, nanoseconds, nanoseconds });
+}
+
+typedef void (*SimTimingVisitor)(int plugin, const char* phase, long long calls, double totalMs, double maxMs, void* refcon);
+
+extern "C" XPLM_API void SimVisitTimings(SimTimingVisitor visitor, void* refcon);
+extern "C" XPLM_API void SimResetTimings();
+
+// Reports the time spent by each plugin in the callbacks of each phase.
+void SimVisitTimings(SimTimingVisitor visitor, void* refcon)
+{
+    for (auto& timing : timings)
+    {
+        visitor(timing.plugin, timing.phase, timing.calls, timing.totalNanoseconds / 1e6, timing.maxNanoseconds / 1e6, refcon);
+    }
+}
+
+void SimResetTimings()
+{
+    timings.clear();
+}
@@ -0,0 +1,213 @@
+#include <XPLMUtilities.h>
+#include "Sim.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The command API of XPLMUtilities.h. The commands have no built-in behavior, so a command only runs its handlers.
+//
+// The handlers of a command are kept in two chains. The before handlers run from the last registered to the first,
+// and then the after handlers from the first registered to the last, so the last plugin to register has the first
+// and the last word. A handler which returns 0 stops the processing of the command, including the after handlers.
+//
+// The handlers may register and unregister handlers, and fire commands, while the command is dispatched.
+// The handlers registered during the dispatch run from the next one, and the unregistered ones are only marked
+// as removed until the dispatch ends, so the dispatch never copies the chains.
+
+struct CommandHandler
+{
+    XPLMPluginID plugin;
+    XPLMCommandCallback_f callback;
+    void* refcon;
+    bool removed;
+};
+
+struct Command
+{
+    std::string name;
+    std::string description;
+    std::vector<CommandHandler> before;
+    std::vector<CommandHandler> after;
+    // The number of the XPLMCommandBegin calls not yet balanced by XPLMCommandEnd.
+    int held = 0;
+    int dispatching = 0;
+    bool hasRemoved = false;
+};
+
+static std::deque<Command> commands;
+static std::unordered_map<std::string, Command*> commandsByName;
+// The commands which are held, and get the continue phase every frame.
+static std::vector<Command*> heldCommands;
+
+static void RemoveHandlers(Command* command)
+{
+    auto isRemoved = [](const CommandHandler& handler) { return handler.removed; };
+    command->before.erase(std::remove_if(command->before.begin(), command->before.end(), isRemoved), command->before.end());
+    command->after.erase(std::remove_if(command->after.begin(), command->after.end(), isRemoved), command->after.end());
+    command->hasRemoved = false;
+}
+
+// Returns false if the handler has stopped the processing of the command.
+static bool CallHandler(Command* command, const CommandHandler& handler, XPLMCommandPhase phase, const char* timingPhase, int& called)
+{
+    if (handler.removed)
+        return true;
+
+    // The handler is copied, since the chain may grow during the call.
+    auto callback = handler.callback;
+    auto refcon = handler.refcon;
+    SimCallbackScope scope(handler.plugin, timingPhase);
+    called++;
+    return callback(command, phase, refcon) != 0;
+}
+
+// Runs the handlers of the command for the phase. Returns the number of the handlers called.
+static int Dispatch(Command* command, XPLMCommandPhase phase)
+{
+    int called = 0;
+    command->dispatching++;
+
+    bool proceed = true;
+    for (auto i = command->before.size(); proceed && i-- > 0;)
+    {
+        proceed = CallHandler(command, command->before[i], phase, "command_before", called);
+    }
+
+    auto afterCount = command->after.size();
+    for (size_t i = 0; proceed && i < afterCount; i++)
+    {
+        proceed = CallHandler(command, command->after[i], phase, "command_after", called);
+    }
+
+    if (--command->dispatching == 0 && command->hasRemoved)
+    {
+        RemoveHandlers(command);
+    }
+    return called;
+}
+
+XPLMCommandRef XPLMFindCommand(const char* inName)
+{
+    auto found = commandsByName.find(inName);
+    return found != commandsByName.end() ? found->second : nullptr;
+}
+
+XPLMCommandRef XPLMCreateCommand(const char* inName, const char* inDescription)
+{
+    auto& command = commandsByName[inName];
+    if (command == nullptr)
+    {
+        commands.push_back(Command { inName, inDescription != nullptr ? inDescription : "", {}, {} });
+        command = &commands.back();
+    }
+    return command;
+}
+
+static int Begin(Command* command)
+{
+    if (command->held++ == 0)
+    {
+        heldCommands.push_back(command);
+    }
+    return Dispatch(command, xplm_CommandBegin);
+}
+
+static int End(Command* command)
+{
+    if (command->held == 0)
+        return 0;
+
+    if (--command->held == 0)
+    {
+        heldCommands.erase(std::find(heldCommands.begin(), heldCommands.end(), command));
+    }
+    return Dispatch(command, xplm_CommandEnd);
+}
+
+void XPLMCommandBegin(XPLMCommandRef inCommand)
+{
+    if (inCommand != nullptr)
+    {
+        Begin((Command*)inCommand);
+    }
+}
+
+void XPLMCommandEnd(XPLMCommandRef inCommand)
+{
+    if (inCommand != nullptr)
+    {
+        End((Command*)inCommand);
+    }
+}
+
+void XPLMCommandOnce(XPLMCommandRef inCommand)
+{
+    XPLMCommandBegin(inCommand);
+    XPLMCommandEnd(inCommand);
+}
+
+void XPLMRegisterCommandHandler(XPLMCommandRef inComand, XPLMCommandCallback_f inHandler, int inBefore, void* inRefcon)
+{
+    auto command = (Command*)inComand;
+    if (command == nullptr || inHandler == nullptr)
+        return;
+
+    auto& chain = inBefore ? command->before : command->after;
+    chain.push_back(CommandHandler { SimGetCurrentPlugin(), inHandler, inRefcon, false });
+}
+
+void XPLMUnregisterCommandHandler(XPLMCommandRef inComand, XPLMCommandCallback_f inHandler, int inBefore, void* inRefcon)
+{
+    auto command = (Command*)inComand;
+    if (command == nullptr)
+        return;
+
+    auto& chain = inBefore ? command->before : command->after;
+    auto found = std::find_if(chain.begin(), chain.end(), [&](const CommandHandler& handler) {
+        return !handler.removed && handler.callback == inHandler && handler.refcon == inRefcon;
+    });
+    if (found == chain.end())
+        return;
+
+    if (command->dispatching > 0)
+    {
+        found->removed = true;
+        command->hasRemoved = true;
+    }
+    else
+    {
+        chain.erase(found);
+    }
+}
+
+int SimContinueHeldCommands()
+{
+    int called = 0;
+    // A handler may end a held command, so the list is walked by index over the commands held before the frame.
+    auto count = heldCommands.size();
+    for (size_t i = 0; i < count && i < heldCommands.size(); i++)
+    {
+        called += Dispatch(heldCommands[i], xplm_CommandContinue);
+    }
+    return called;
+}
+
+extern "C" XPLM_API int SimFireCommand(XPLMCommandRef command, int count);
+
+// Executes the command count times, like XPLMCommandOnce. Returns the number of the handlers called.
+int SimFireCommand(XPLMCommandRef command, int count)
+{
+    if (command == nullptr)
+        return 0;
+
+    int called = 0;
+    for (int i = 0; i < count; i++)
+    {
+        called += Begin((Command*)command);
+        called += End((Command*)command);
+    }
+    return called;
+}
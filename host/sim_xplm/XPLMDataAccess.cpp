@@ -0,0 +1,620 @@
+#include <XPLMDataAccess.h>
+#include "Sim.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// The datarefs are kept in a deque, so that the handles stay valid while new datarefs are added,
+// and they are found by name through a hash index. A dataref is never removed: an unregistered
+// dataref becomes orphaned and can be registered again under the same handle, like in X-Plane.
+//
+// The values of the shared datarefs and the datarefs defined by the simulator are kept in
+// contiguous typed pools and accessed through built-in accessors, so all datarefs are read
+// and written the same way.
+
+struct Notification
+{
+    XPLMDataChanged_f func;
+    void* refcon;
+};
+
+struct DataRefRecord
+{
+    std::string name;
+    XPLMDataTypeID types = xplmType_Unknown;
+    bool writable = false;
+    bool good = false;
+    bool shared = false;
+    // Defined by the simulator with SimDefineDataRef.
+    bool owned = false;
+
+    XPLMGetDatai_f readInt = nullptr;
+    XPLMSetDatai_f writeInt = nullptr;
+    XPLMGetDataf_f readFloat = nullptr;
+    XPLMSetDataf_f writeFloat = nullptr;
+    XPLMGetDatad_f readDouble = nullptr;
+    XPLMSetDatad_f writeDouble = nullptr;
+    XPLMGetDatavi_f readIntArray = nullptr;
+    XPLMSetDatavi_f writeIntArray = nullptr;
+    XPLMGetDatavf_f readFloatArray = nullptr;
+    XPLMSetDatavf_f writeFloatArray = nullptr;
+    XPLMGetDatab_f readData = nullptr;
+    XPLMSetDatab_f writeData = nullptr;
+    void* readRefcon = nullptr;
+    void* writeRefcon = nullptr;
+
+    // The location of the value in the pool of its type, for the datarefs backed by the built-in storage.
+    size_t offset = 0;
+    int length = 0;
+    int capacity = 0;
+
+    std::vector<Notification> notifications;
+};
+
+static std::deque<DataRefRecord> records;
+// The keys point to the names of the records, so the lookup does not allocate.
+static std::unordered_map<std::string_view, DataRefRecord*> nameIndex;
+
+static std::vector<int> intPool;
+static std::vector<float> floatPool;
+static std::vector<double> doublePool;
+static std::vector<uint8_t> bytePool;
+
+static DataRefRecord* GetOrAddRecord(const char* name)
+{
+    auto value = nameIndex.find(name);
+    if (value != nameIndex.end())
+        return value->second;
+
+    auto& record = records.emplace_back();
+    record.name = name;
+    nameIndex.emplace(record.name, &record);
+    return &record;
+}
+
+// The blocks of the pool of a type which have been left by the values that have grown or by the reset records,
+// as offsets and capacities.
+template <typename T>
+static std::vector<std::pair<size_t, int>>& GetFreeBlocks()
+{
+    static std::vector<std::pair<size_t, int>> freeBlocks;
+    return freeBlocks;
+}
+
+// Reserves a block in the pool. A block that has to grow is extended if it is at the end of the pool,
+// and otherwise moved to a free block or to the end of the pool, and its old block is freed.
+template <typename T>
+static void Reserve(std::vector<T>& pool, DataRefRecord& record, int capacity)
+{
+    if (capacity <= record.capacity)
+        return;
+
+    // The shared arrays grow as they are written, so the capacity is at least doubled.
+    capacity = std::max(capacity, record.capacity * 2);
+    if (record.capacity > 0 && record.offset + record.capacity == pool.size())
+    {
+        pool.resize(record.offset + capacity);
+        record.capacity = capacity;
+        return;
+    }
+
+    size_t offset;
+    auto& freeBlocks = GetFreeBlocks<T>();
+    auto block = std::find_if(freeBlocks.begin(), freeBlocks.end(), [=](const std::pair<size_t, int>& b) { return b.second >= capacity; });
+    if (block != freeBlocks.end())
+    {
+        offset = block->first;
+        capacity = block->second;
+        freeBlocks.erase(block);
+        std::fill_n(pool.begin() + offset, capacity, T {});
+    }
+    else
+    {
+        offset = pool.size();
+        pool.resize(offset + capacity);
+    }
+
+    if (record.length > 0)
+    {
+        std::copy_n(pool.begin() + record.offset, record.length, pool.begin() + offset);
+    }
+    if (record.capacity > 0)
+    {
+        freeBlocks.emplace_back(record.offset, record.capacity);
+    }
+    record.offset = offset;
+    record.capacity = capacity;
+}
+
+// Clears the record, keeping the name buffer, which is referenced by the index.
+// The block of the built-in storage of the record is returned to the free blocks of its pool.
+static void ResetRecord(DataRefRecord& record)
+{
+    if (record.readRefcon == &record && record.capacity > 0)
+    {
+        auto block = std::make_pair(record.offset, record.capacity);
+        switch (record.types)
+        {
+        case xplmType_Int:
+        case xplmType_IntArray:
+            GetFreeBlocks<int>().push_back(block);
+            break;
+        case xplmType_Float:
+        case xplmType_FloatArray:
+            GetFreeBlocks<float>().push_back(block);
+            break;
+        case xplmType_Double:
+            GetFreeBlocks<double>().push_back(block);
+            break;
+        case xplmType_Data:
+            GetFreeBlocks<uint8_t>().push_back(block);
+            break;
+        default:
+            break;
+        }
+    }
+
+    auto name = std::move(record.name);
+    record = DataRefRecord {};
+    record.name = std::move(name);
+}
+
+static void Notify(DataRefRecord& record)
+{
+    // A notification function may unshare the data, so the list is copied.
+    auto notifications = record.notifications;
+    for (auto& notification : notifications)
+    {
+        notification.func(notification.refcon);
+    }
+}
+
+template <typename T>
+static int ReadArray(const std::vector<T>& pool, const DataRefRecord& record, T* outValues, int inOffset, int inMax)
+{
+    if (outValues == nullptr)
+        return record.length;
+
+    if (inOffset < 0 || inOffset >= record.length || inMax <= 0)
+        return 0;
+
+    auto count = std::min(inMax, record.length - inOffset);
+    std::copy_n(pool.begin() + record.offset + inOffset, count, outValues);
+    return count;
+}
+
+template <typename T>
+static void WriteArray(std::vector<T>& pool, DataRefRecord& record, const T* inValues, int inOffset, int inCount)
+{
+    if (inValues == nullptr || inOffset < 0 || inCount <= 0)
+        return;
+
+    // The arrays of the shared data grow to fit the written values, the others are fixed.
+    if (record.shared)
+    {
+        Reserve(pool, record, inOffset + inCount);
+        record.length = std::max(record.length, inOffset + inCount);
+    }
+    else
+    {
+        inCount = std::min(inCount, record.length - inOffset);
+        if (inCount <= 0)
+            return;
+    }
+
+    std::copy_n(inValues, inCount, pool.begin() + record.offset + inOffset);
+    if (record.shared)
+    {
+        Notify(record);
+    }
+}
+
+static int StorageGetInt(void* refcon)
+{
+    return intPool[((DataRefRecord*)refcon)->offset];
+}
+
+static void StorageSetInt(void* refcon, int value)
+{
+    auto record = (DataRefRecord*)refcon;
+    intPool[record->offset] = value;
+    if (record->shared)
+    {
+        Notify(*record);
+    }
+}
+
+static float StorageGetFloat(void* refcon)
+{
+    return floatPool[((DataRefRecord*)refcon)->offset];
+}
+
+static void StorageSetFloat(void* refcon, float value)
+{
+    auto record = (DataRefRecord*)refcon;
+    floatPool[record->offset] = value;
+    if (record->shared)
+    {
+        Notify(*record);
+    }
+}
+
+static double StorageGetDouble(void* refcon)
+{
+    return doublePool[((DataRefRecord*)refcon)->offset];
+}
+
+static void StorageSetDouble(void* refcon, double value)
+{
+    auto record = (DataRefRecord*)refcon;
+    doublePool[record->offset] = value;
+    if (record->shared)
+    {
+        Notify(*record);
+    }
+}
+
+static int StorageGetIntArray(void* refcon, int* outValues, int inOffset, int inMax)
+{
+    return ReadArray(intPool, *(DataRefRecord*)refcon, outValues, inOffset, inMax);
+}
+
+static void StorageSetIntArray(void* refcon, int* inValues, int inOffset, int inCount)
+{
+    WriteArray(intPool, *(DataRefRecord*)refcon, inValues, inOffset, inCount);
+}
+
+static int StorageGetFloatArray(void* refcon, float* outValues, int inOffset, int inMax)
+{
+    return ReadArray(floatPool, *(DataRefRecord*)refcon, outValues, inOffset, inMax);
+}
+
+static void StorageSetFloatArray(void* refcon, float* inValues, int inOffset, int inCount)
+{
+    WriteArray(floatPool, *(DataRefRecord*)refcon, inValues, inOffset, inCount);
+}
+
+static int StorageGetData(void* refcon, void* outValue, int inOffset, int inMaxLength)
+{
+    return ReadArray(bytePool, *(DataRefRecord*)refcon, (uint8_t*)outValue, inOffset, inMaxLength);
+}
+
+static void StorageSetData(void* refcon, void* inValue, int inOffset, int inLength)
+{
+    WriteArray(bytePool, *(DataRefRecord*)refcon, (const uint8_t*)inValue, inOffset, inLength);
+}
+
+// Connects the record to the built-in storage of the given type.
+static bool AttachStorage(DataRefRecord& record, XPLMDataTypeID type, int length)
+{
+    record.types = type;
+    record.readRefcon = record.writeRefcon = &record;
+    record.length = length;
+    switch (type)
+    {
+    case xplmType_Int:
+        record.length = 1;
+        Reserve(intPool, record, 1);
+        record.readInt = StorageGetInt;
+        record.writeInt = StorageSetInt;
+        return true;
+    case xplmType_Float:
+        record.length = 1;
+        Reserve(floatPool, record, 1);
+        record.readFloat = StorageGetFloat;
+        record.writeFloat = StorageSetFloat;
+        return true;
+    case xplmType_Double:
+        record.length = 1;
+        Reserve(doublePool, record, 1);
+        record.readDouble = StorageGetDouble;
+        record.writeDouble = StorageSetDouble;
+        return true;
+    case xplmType_IntArray:
+        Reserve(intPool, record, length);
+        record.readIntArray = StorageGetIntArray;
+        record.writeIntArray = StorageSetIntArray;
+        return true;
+    case xplmType_FloatArray:
+        Reserve(floatPool, record, length);
+        record.readFloatArray = StorageGetFloatArray;
+        record.writeFloatArray = StorageSetFloatArray;
+        return true;
+    case xplmType_Data:
+        Reserve(bytePool, record, length);
+        record.readData = StorageGetData;
+        record.writeData = StorageSetData;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Defines a dataref owned by the simulator, backed by the built-in storage.
+// Array and data datarefs have a fixed length; the values are initialized with zeros.
+XPLMDataRef SimDefineDataRef(const char* name, XPLMDataTypeID type, int length, int writable)
+{
+    auto record = GetOrAddRecord(name);
+    if (record->good)
+        return record->types == type ? record : nullptr;
+
+    ResetRecord(*record);
+    if (!AttachStorage(*record, type, std::max(length, 0)))
+        return nullptr;
+
+    record->writable = writable != 0;
+    record->owned = true;
+    record->good = true;
+    return record;
+}
+
+std::vector<SimDataRefInfo> SimGetOwnedDataRefs()
+{
+    std::vector<SimDataRefInfo> result;
+    for (auto& record : records)
+    {
+        if (record.good && record.owned)
+        {
+            result.push_back(SimDataRefInfo { &record, record.name.c_str(), record.types, record.length });
+        }
+    }
+    return result;
+}
+
+void* SimGetDataRefStorage(XPLMDataRef ref, int* outLength)
+{
+    auto record = (DataRefRecord*)ref;
+    if (!record->good || !record->owned)
+        return nullptr;
+
+    if (outLength != nullptr)
+    {
+        *outLength = record->length;
+    }
+    switch (record->types)
+    {
+    case xplmType_Int:
+    case xplmType_IntArray:
+        return intPool.data() + record->offset;
+    case xplmType_Float:
+    case xplmType_FloatArray:
+        return floatPool.data() + record->offset;
+    case xplmType_Double:
+        return doublePool.data() + record->offset;
+    case xplmType_Data:
+        return bytePool.data() + record->offset;
+    default:
+        return nullptr;
+    }
+}
+
+bool SimSetDataRefWritable(XPLMDataRef ref, bool writable)
+{
+    return std::exchange(((DataRefRecord*)ref)->writable, writable);
+}
+
+XPLMDataRef XPLMFindDataRef(const char* inDataRefName)
+{
+    if (inDataRefName == nullptr)
+        return nullptr;
+
+    auto value = nameIndex.find(inDataRefName);
+    return value != nameIndex.end() ? value->second : nullptr;
+}
+
+int XPLMCanWriteDataRef(XPLMDataRef inDataRef)
+{
+    auto record = (DataRefRecord*)inDataRef;
+    return record != nullptr && record->good && record->writable;
+}
+
+int XPLMIsDataRefGood(XPLMDataRef inDataRef)
+{
+    auto record = (DataRefRecord*)inDataRef;
+    return record != nullptr && record->good;
+}
+
+XPLMDataTypeID XPLMGetDataRefTypes(XPLMDataRef inDataRef)
+{
+    auto record = (DataRefRecord*)inDataRef;
+    return record != nullptr && record->good ? record->types : xplmType_Unknown;
+}
+
+// The readers return 0 for null, orphaned or mismatching datarefs, and the writers ignore them.
+#define READER(ref, accessor) \
+    auto record = (DataRefRecord*)(ref); \
+    if (record == nullptr || !record->good || record->accessor == nullptr) \
+        return 0;
+
+#define WRITER(ref, accessor) \
+    auto record = (DataRefRecord*)(ref); \
+    if (record == nullptr || !record->good || !record->writable || record->accessor == nullptr) \
+        return;
+
+int XPLMGetDatai(XPLMDataRef inDataRef)
+{
+    READER(inDataRef, readInt);
+    return record->readInt(record->readRefcon);
+}
+
+void XPLMSetDatai(XPLMDataRef inDataRef, int inValue)
+{
+    WRITER(inDataRef, writeInt);
+    record->writeInt(record->writeRefcon, inValue);
+}
+
+float XPLMGetDataf(XPLMDataRef inDataRef)
+{
+    READER(inDataRef, readFloat);
+    return record->readFloat(record->readRefcon);
+}
+
+void XPLMSetDataf(XPLMDataRef inDataRef, float inValue)
+{
+    WRITER(inDataRef, writeFloat);
+    record->writeFloat(record->writeRefcon, inValue);
+}
+
+double XPLMGetDatad(XPLMDataRef inDataRef)
+{
+    READER(inDataRef, readDouble);
+    return record->readDouble(record->readRefcon);
+}
+
+void XPLMSetDatad(XPLMDataRef inDataRef, double inValue)
+{
+    WRITER(inDataRef, writeDouble);
+    record->writeDouble(record->writeRefcon, inValue);
+}
+
+int XPLMGetDatavi(XPLMDataRef inDataRef, int* outValues, int inOffset, int inMax)
+{
+    READER(inDataRef, readIntArray);
+    return record->readIntArray(record->readRefcon, outValues, inOffset, inMax);
+}
+
+void XPLMSetDatavi(XPLMDataRef inDataRef, int* inValues, int inoffset, int inCount)
+{
+    WRITER(inDataRef, writeIntArray);
+    record->writeIntArray(record->writeRefcon, inValues, inoffset, inCount);
+}
+
+int XPLMGetDatavf(XPLMDataRef inDataRef, float* outValues, int inOffset, int inMax)
+{
+    READER(inDataRef, readFloatArray);
+    return record->readFloatArray(record->readRefcon, outValues, inOffset, inMax);
+}
+
+void XPLMSetDatavf(XPLMDataRef inDataRef, float* inValues, int inoffset, int inCount)
+{
+    WRITER(inDataRef, writeFloatArray);
+    record->writeFloatArray(record->writeRefcon, inValues, inoffset, inCount);
+}
+
+int XPLMGetDatab(XPLMDataRef inDataRef, void* outValue, int inOffset, int inMaxBytes)
+{
+    READER(inDataRef, readData);
+    return record->readData(record->readRefcon, outValue, inOffset, inMaxBytes);
+}
+
+void XPLMSetDatab(XPLMDataRef inDataRef, void* inValue, int inOffset, int inLength)
+{
+    WRITER(inDataRef, writeData);
+    record->writeData(record->writeRefcon, inValue, inOffset, inLength);
+}
+
+XPLMDataRef XPLMRegisterDataAccessor(
+    const char* inDataName,
+    XPLMDataTypeID inDataType,
+    int inIsWritable,
+    XPLMGetDatai_f inReadInt,
+    XPLMSetDatai_f inWriteInt,
+    XPLMGetDataf_f inReadFloat,
+    XPLMSetDataf_f inWriteFloat,
+    XPLMGetDatad_f inReadDouble,
+    XPLMSetDatad_f inWriteDouble,
+    XPLMGetDatavi_f inReadIntArray,
+    XPLMSetDatavi_f inWriteIntArray,
+    XPLMGetDatavf_f inReadFloatArray,
+    XPLMSetDatavf_f inWriteFloatArray,
+    XPLMGetDatab_f inReadData,
+    XPLMSetDatab_f inWriteData,
+    void* inReadRefcon,
+    void* inWriteRefcon)
+{
+    if (inDataName == nullptr)
+        return nullptr;
+
+    auto record = GetOrAddRecord(inDataName);
+    if (record->good)
+        return nullptr;
+
+    ResetRecord(*record);
+    record->types = inDataType;
+    record->writable = inIsWritable != 0;
+    record->readInt = inReadInt;
+    record->writeInt = inWriteInt;
+    record->readFloat = inReadFloat;
+    record->writeFloat = inWriteFloat;
+    record->readDouble = inReadDouble;
+    record->writeDouble = inWriteDouble;
+    record->readIntArray = inReadIntArray;
+    record->writeIntArray = inWriteIntArray;
+    record->readFloatArray = inReadFloatArray;
+    record->writeFloatArray = inWriteFloatArray;
+    record->readData = inReadData;
+    record->writeData = inWriteData;
+    record->readRefcon = inReadRefcon;
+    record->writeRefcon = inWriteRefcon;
+    record->good = true;
+    return record;
+}
+
+void XPLMUnregisterDataAccessor(XPLMDataRef inDataRef)
+{
+    auto record = (DataRefRecord*)inDataRef;
+    if (record == nullptr || record->shared)
+        return;
+
+    ResetRecord(*record);
+}
+
+int XPLMShareData(
+    const char* inDataName,
+    XPLMDataTypeID inDataType,
+    XPLMDataChanged_f inNotificationFunc,
+    void* inNotificationRefcon)
+{
+    if (inDataName == nullptr)
+        return 0;
+
+    auto record = GetOrAddRecord(inDataName);
+    if (!record->good)
+    {
+        ResetRecord(*record);
+        if (!AttachStorage(*record, inDataType, 0))
+            return 0;
+
+        record->writable = true;
+        record->shared = true;
+        record->good = true;
+    }
+    else if (!record->shared || record->types != inDataType)
+    {
+        return 0;
+    }
+
+    if (inNotificationFunc != nullptr)
+    {
+        record->notifications.push_back(Notification { inNotificationFunc, inNotificationRefcon });
+    }
+    return 1;
+}
+
+int XPLMUnshareData(
+    const char* inDataName,
+    XPLMDataTypeID inDataType,
+    XPLMDataChanged_f inNotificationFunc,
+    void* inNotificationRefcon)
+{
+    auto record = (DataRefRecord*)XPLMFindDataRef(inDataName);
+    if (record == nullptr || !record->shared || record->types != inDataType)
+        return 0;
+
+    auto& notifications = record->notifications;
+    auto value = std::find_if(notifications.begin(), notifications.end(), [&](const Notification& n) {
+        return n.func == inNotificationFunc && n.refcon == inNotificationRefcon;
+    });
+    if (value == notifications.end())
+        return 0;
+
+    notifications.erase(value);
+    return 1;
+}
@@ -0,0 +1,125 @@
+#include <XPLMDisplay.h>
+#include "Sim.h"
+
+#include <algorithm>
+#include <vector>
+
+// There is no GL context: SimDrawFrame calls the draw callbacks of every phase, and the windows in the window phase,
+// see XPLMWindows.cpp. The time spent in them is recorded per plugin and phase.
+
+struct DrawCallback
+{
+    XPLMPluginID plugin;
+    XPLMDrawCallback_f callback;
+    XPLMDrawingPhase phase;
+    int wantsBefore;
+    void* refcon;
+    bool removed;
+};
+
+struct DrawPhase
+{
+    XPLMDrawingPhase phase;
+    const char* name;
+};
+
+// xplm_Phase_Modern3D, the 3D phase of X-Plane 11.50 and later, which replaces the deprecated 3D phases.
+// It is defined by the XPLM302 SDK, and the sim is built with an older API level.
+#if defined(XPLM302)
+static const XPLMDrawingPhase Modern3DPhase = xplm_Phase_Modern3D;
+#else
+static const XPLMDrawingPhase Modern3DPhase = 31;
+#endif
+
+// The phases in the order X-Plane draws them. The names are the timing keys, see SimRecordTiming.
+static const DrawPhase drawPhases[] =
+{
+    { Modern3DPhase, "draw_modern_3d" },
+    { xplm_Phase_FirstCockpit, "draw_first_cockpit" },
+    { xplm_Phase_Panel, "draw_panel" },
+    { xplm_Phase_Gauges, "draw_gauges" },
+    { xplm_Phase_Window, "draw_window" },
+    { xplm_Phase_LastCockpit, "draw_last_cockpit" },
+    { xplm_Phase_LocalMap3D, "draw_local_map_3d" },
+    { xplm_Phase_LocalMap2D, "draw_local_map_2d" },
+    { xplm_Phase_LocalMapProfile, "draw_local_map_profile" },
+};
+
+static std::vector<DrawCallback> drawCallbacks;
+static bool drawing = false;
+
+static bool IsKnownPhase(XPLMDrawingPhase phase)
+{
+    return std::any_of(std::begin(drawPhases), std::end(drawPhases), [=](const DrawPhase& p) { return p.phase == phase; });
+}
+
+static int DrawPhaseCallbacks(const DrawPhase& phase, int before)
+{
+    int called = 0;
+    // Callbacks registered while drawing are called from the next frame on.
+    auto count = drawCallbacks.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& callback = drawCallbacks[i];
+        if (callback.removed || callback.phase != phase.phase || callback.wantsBefore != before)
+            continue;
+
+        auto function = callback.callback;
+        auto refcon = callback.refcon;
+        SimCallbackScope scope(callback.plugin, phase.name);
+        function(phase.phase, before, refcon);
+        called++;
+    }
+    return called;
+}
+
+extern "C" XPLM_API int SimDrawFrame();
+
+// Calls the draw callbacks of every phase, before and after, and draws the windows between the window phase callbacks.
+// Returns the number of callbacks called.
+int SimDrawFrame()
+{
+    int called = 0;
+    drawing = true;
+    for (auto& phase : drawPhases)
+    {
+        called += DrawPhaseCallbacks(phase, 1);
+        if (phase.phase == xplm_Phase_Window)
+        {
+            called += SimDrawWindows();
+        }
+        called += DrawPhaseCallbacks(phase, 0);
+    }
+    drawing = false;
+
+    drawCallbacks.erase(std::remove_if(drawCallbacks.begin(), drawCallbacks.end(), [](auto& c) { return c.removed; }), drawCallbacks.end());
+    return called;
+}
+
+int XPLMRegisterDrawCallback(XPLMDrawCallback_f inCallback, XPLMDrawingPhase inPhase, int inWantsBefore, void* inRefcon)
+{
+    if (inCallback == nullptr || !IsKnownPhase(inPhase))
+        return 0;
+
+    drawCallbacks.push_back(DrawCallback { SimGetCurrentPlugin(), inCallback, inPhase, inWantsBefore != 0, inRefcon, false });
+    return 1;
+}
+
+int XPLMUnregisterDrawCallback(XPLMDrawCallback_f inCallback, XPLMDrawingPhase inPhase, int inWantsBefore, void* inRefcon)
+{
+    for (auto& callback : drawCallbacks)
+    {
+        if (!callback.removed && callback.callback == inCallback && callback.phase == inPhase &&
+            callback.wantsBefore == (inWantsBefore != 0) && callback.refcon == inRefcon)
+        {
+            // The callbacks may be unregistered while drawing, so they are removed after the frame.
+            callback.removed = true;
+            if (!drawing)
+            {
+                drawCallbacks.erase(std::find_if(drawCallbacks.begin(), drawCallbacks.end(), [](auto& c) { return c.removed; }));
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <XPLMInstance.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// The instances are not drawn, so an instance only keeps the last position and dataref values set for it.
+// SimInstanceSetPositions sets many instances at once, like the batch of xphost, so that the cost of the updates
+// can be measured without the native/managed transitions.
+
+struct Instance
+{
+    XPLMObjectRef object;
+    std::vector<std::string> dataRefs;
+    XPLMDrawInfo_t position;
+    std::vector<float> data;
+};
+
+XPLMInstanceRef XPLMCreateInstance(XPLMObjectRef obj, const char** datarefs)
+{
+    if (obj == nullptr || datarefs == nullptr)
+        return nullptr;
+
+    auto instance = new Instance { obj, {}, {}, {} };
+    for (auto dataRef = datarefs; *dataRef != nullptr; dataRef++)
+    {
+        instance->dataRefs.emplace_back(*dataRef);
+    }
+    instance->position.structSize = sizeof(XPLMDrawInfo_t);
+    instance->data.resize(instance->dataRefs.size());
+    return instance;
+}
+
+void XPLMDestroyInstance(XPLMInstanceRef instance)
+{
+    delete (Instance*)instance;
+}
+
+static void SetPosition(Instance* instance, const XPLMDrawInfo_t* position, const float* data)
+{
+    instance->position = *position;
+    if (!instance->data.empty())
+    {
+        memcpy(instance->data.data(), data, instance->data.size() * sizeof(float));
+    }
+}
+
+void XPLMInstanceSetPosition(XPLMInstanceRef instance, const XPLMDrawInfo_t* new_position, const float* data)
+{
+    if (instance == nullptr || new_position == nullptr)
+        return;
+
+    SetPosition((Instance*)instance, new_position, data);
+}
+
+extern "C" XPLM_API void SimInstanceSetPositions(const XPLMInstanceRef* instances, int count, const XPLMDrawInfo_t* positions, const float* data, const int* dataOffsets);
+
+// Sets the positions of count instances. The dataref values of instance i start at data + dataOffsets[i].
+void SimInstanceSetPositions(const XPLMInstanceRef* instances, int count, const XPLMDrawInfo_t* positions, const float* data, const int* dataOffsets)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (instances[i] != nullptr)
+        {
+            SetPosition((Instance*)instances[i], positions + i, data + dataOffsets[i]);
+        }
+    }
+}
+
+extern "C" XPLM_API int SimGetInstancePosition(XPLMInstanceRef instance, XPLMDrawInfo_t* position, float* data, int maxData);
+
+// Gets the last position and dataref values set for the instance, for the harness to check. Returns the number of the datarefs.
+int SimGetInstancePosition(XPLMInstanceRef instance, XPLMDrawInfo_t* position, float* data, int maxData)
+{
+    auto value = (Instance*)instance;
+    if (position != nullptr)
+        *position = value->position;
+
+    auto count = (int)value->data.size();
+    if (data != nullptr)
+        memcpy(data, value->data.data(), (count < maxData ? count : maxData) * sizeof(float));
+    return count;
+}
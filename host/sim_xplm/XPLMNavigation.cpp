@@ -0,0 +1,498 @@
+#include <XPLMNavigation.h>
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// The navaid database, loaded from a file in the earth_nav.dat format by SimLoadNavData.
+//
+// The navaids are sorted by type, like in X-Plane, so the navaids of one type have consecutive refs.
+// XPLMFindNavAid uses two indexes: a hash of the IDs, which finds an exact ID without a position, and a static
+// k-d tree of the positions on the unit sphere, in which the nearest navaid is searched. The straight-line distance between the points
+// on the sphere grows with the great circle distance, so the nearest point is also the nearest navaid.
+//
+// There is a tree per navaid type, over the range of the refs of the type, so a search only visits the
+// navaids of the requested types. The trees are implicit: the navaids of a subtree are a range of the
+// tree array, and its root is the middle of the range. The nodes keep a copy of the positions, so the
+// search does not touch the navaid records until a navaid is near enough.
+
+struct NavAidRecord
+{
+    XPLMNavType type;
+    float latitude;
+    float longitude;
+    float height;
+    float heading;
+    int frequency;
+    // The offsets of the ID and the name in the string pool.
+    uint32_t id;
+    uint32_t name;
+    // The position on the unit sphere, which the distances are computed with.
+    float position[3];
+};
+
+static std::vector<NavAidRecord> navAids;
+static std::string stringPool;
+static std::unordered_map<std::string_view, std::vector<XPLMNavRef>> idIndex;
+struct TreeNode
+{
+    float position[3];
+    XPLMNavRef ref : 30;
+    // The axis of the split at the node.
+    unsigned axis : 2;
+};
+
+static std::vector<TreeNode> tree;
+
+static XPLMNavType GetNavType(int rowCode)
+{
+    switch (rowCode)
+    {
+    case 2: return xplm_Nav_NDB;
+    case 3: return xplm_Nav_VOR;
+    case 4: return xplm_Nav_ILS;
+    case 5: return xplm_Nav_Localizer;
+    case 6: return xplm_Nav_GlideSlope;
+    case 7: return xplm_Nav_OuterMarker;
+    case 8: return xplm_Nav_MiddleMarker;
+    case 9: return xplm_Nav_InnerMarker;
+    case 12:
+    case 13: return xplm_Nav_DME;
+    default: return xplm_Nav_Unknown;
+    }
+}
+
+static void GetUnitVector(float latitude, float longitude, float* position)
+{
+    const double toRadians = 3.14159265358979323846 / 180;
+    auto lat = latitude * toRadians;
+    auto lon = longitude * toRadians;
+    position[0] = (float)(std::cos(lat) * std::cos(lon));
+    position[1] = (float)(std::cos(lat) * std::sin(lon));
+    position[2] = (float)std::sin(lat);
+}
+
+// The fields of a line, which ends at a line break or at the end of the file.
+class LineReader
+{
+private:
+    const char* current;
+    const char* end;
+
+public:
+    LineReader(const char* begin, const char* end) : current(begin), end(end)
+    {
+    }
+
+    bool AtEnd()
+    {
+        SkipSpaces();
+        return current == end || *current == '\n' || *current == '\r';
+    }
+
+    void SkipSpaces()
+    {
+        while (current != end && (*current == ' ' || *current == '\t'))
+            current++;
+    }
+
+    std::string_view ReadField()
+    {
+        SkipSpaces();
+        auto begin = current;
+        while (current != end && *current != ' ' && *current != '\t' && *current != '\n' && *current != '\r')
+            current++;
+        return std::string_view(begin, current - begin);
+    }
+
+    std::string_view ReadRest()
+    {
+        SkipSpaces();
+        auto begin = current;
+        while (current != end && *current != '\n' && *current != '\r')
+            current++;
+        auto rest = std::string_view(begin, current - begin);
+        while (!rest.empty() && (rest.back() == ' ' || rest.back() == '\t'))
+            rest.remove_suffix(1);
+        return rest;
+    }
+
+    // Parses a decimal number without an exponent, which is all the nav data uses.
+    double ReadNumber()
+    {
+        auto field = ReadField();
+        size_t i = 0;
+        bool negative = false;
+        if (i < field.size() && (field[i] == '-' || field[i] == '+'))
+        {
+            negative = field[i] == '-';
+            i++;
+        }
+        double value = 0;
+        for (; i < field.size() && field[i] >= '0' && field[i] <= '9'; i++)
+        {
+            value = value * 10 + (field[i] - '0');
+        }
+        if (i < field.size() && field[i] == '.')
+        {
+            double scale = 0.1;
+            for (i++; i < field.size() && field[i] >= '0' && field[i] <= '9'; i++, scale *= 0.1)
+            {
+                value += (field[i] - '0') * scale;
+            }
+        }
+        return negative ? -value : value;
+    }
+};
+
+static uint32_t AddString(std::string_view value)
+{
+    auto offset = (uint32_t)stringPool.size();
+    stringPool.append(value);
+    stringPool.push_back('\0');
+    return offset;
+}
+
+// Builds the subtree of the nodes in the range [begin, end) of the tree array.
+static void BuildTree(int begin, int end)
+{
+    if (begin >= end)
+        return;
+
+    // The split is on the axis along which the navaids are spread the most.
+    float low[3] = { 2, 2, 2 }, high[3] = { -2, -2, -2 };
+    for (int i = begin; i < end; i++)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            low[axis] = std::min(low[axis], tree[i].position[axis]);
+            high[axis] = std::max(high[axis], tree[i].position[axis]);
+        }
+    }
+    unsigned splitAxis = 0;
+    for (unsigned axis = 1; axis < 3; axis++)
+    {
+        if (high[axis] - low[axis] > high[splitAxis] - low[splitAxis])
+            splitAxis = axis;
+    }
+
+    auto middle = begin + (end - begin) / 2;
+    std::nth_element(tree.begin() + begin, tree.begin() + middle, tree.begin() + end, [&](const TreeNode& a, const TreeNode& b)
+    {
+        return a.position[splitAxis] < b.position[splitAxis];
+    });
+
+    tree[middle].axis = splitAxis;
+    BuildTree(begin, middle);
+    BuildTree(middle + 1, end);
+}
+
+static void BuildIndexes()
+{
+    // A stable sort keeps the order of the file within each type.
+    std::stable_sort(navAids.begin(), navAids.end(), [](const NavAidRecord& a, const NavAidRecord& b) { return a.type < b.type; });
+
+    idIndex.clear();
+    tree.resize(navAids.size());
+    for (XPLMNavRef ref = 0; ref < (XPLMNavRef)navAids.size(); ref++)
+    {
+        auto& navAid = navAids[ref];
+        idIndex[std::string_view(stringPool.c_str() + navAid.id)].push_back(ref);
+        tree[ref] = TreeNode { { navAid.position[0], navAid.position[1], navAid.position[2] }, ref, 0 };
+    }
+
+    for (int begin = 0, end; begin < (int)navAids.size(); begin = end)
+    {
+        for (end = begin + 1; end < (int)navAids.size() && navAids[end].type == navAids[begin].type; end++)
+        {
+        }
+        BuildTree(begin, end);
+    }
+}
+
+extern "C" XPLM_API int SimLoadNavData(const char* path);
+
+// Loads the navaids from a file in the earth_nav.dat format (versions 1100 and 1150), replacing the loaded ones.
+// The fixes and the airports are not loaded. Returns the number of the navaids loaded, or -1 if the file cannot be read
+// or has another version, in which case the loaded navaids are kept.
+int SimLoadNavData(const char* path)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return -1;
+
+    auto data = (const char*)file.begin();
+    auto end = data + file.length();
+
+    // The file starts with the line ending type ("I" or "A"), and then the version and the copyright.
+    int version = 0;
+    int lineNumber = 0;
+    for (auto line = data; line < end; lineNumber++)
+    {
+        auto lineEnd = (const char*)memchr(line, '\n', end - line);
+        lineEnd = lineEnd != nullptr ? lineEnd + 1 : end;
+        LineReader reader(line, lineEnd);
+        line = lineEnd;
+
+        if (lineNumber == 0)
+            continue;
+        if (lineNumber == 1)
+        {
+            version = (int)reader.ReadNumber();
+            if (version != 1100 && version != 1150)
+                return -1;
+
+            navAids.clear();
+            stringPool.clear();
+            continue;
+        }
+        if (reader.AtEnd())
+            continue;
+
+        auto rowCode = (int)reader.ReadNumber();
+        if (rowCode == 99)
+            break;
+
+        auto type = GetNavType(rowCode);
+        if (type == xplm_Nav_Unknown)
+            continue;
+
+        NavAidRecord navAid {};
+        navAid.type = type;
+        navAid.latitude = (float)reader.ReadNumber();
+        navAid.longitude = (float)reader.ReadNumber();
+        navAid.height = (float)reader.ReadNumber();
+        navAid.frequency = (int)reader.ReadNumber();
+        reader.ReadField(); // range
+        auto heading = reader.ReadNumber();
+        // The glide slopes have the angle in the thousands of the heading.
+        navAid.heading = (float)(type == xplm_Nav_GlideSlope ? std::fmod(heading, 1000.0) : heading);
+        navAid.id = AddString(reader.ReadField());
+        reader.ReadField(); // terminal region or airport
+        reader.ReadField(); // ICAO region
+        navAid.name = AddString(reader.ReadRest());
+        GetUnitVector(navAid.latitude, navAid.longitude, navAid.position);
+        navAids.push_back(navAid);
+    }
+
+    BuildIndexes();
+    return (int)navAids.size();
+}
+
+XPLMNavRef XPLMGetFirstNavAid(void)
+{
+    return navAids.empty() ? XPLM_NAV_NOT_FOUND : 0;
+}
+
+XPLMNavRef XPLMGetNextNavAid(XPLMNavRef inNavAidRef)
+{
+    return inNavAidRef >= 0 && inNavAidRef + 1 < (XPLMNavRef)navAids.size() ? inNavAidRef + 1 : XPLM_NAV_NOT_FOUND;
+}
+
+XPLMNavRef XPLMFindFirstNavAidOfType(XPLMNavType inType)
+{
+    auto found = std::lower_bound(navAids.begin(), navAids.end(), inType, [](const NavAidRecord& navAid, XPLMNavType type) { return navAid.type < type; });
+    return found != navAids.end() && found->type == inType ? (XPLMNavRef)(found - navAids.begin()) : XPLM_NAV_NOT_FOUND;
+}
+
+XPLMNavRef XPLMFindLastNavAidOfType(XPLMNavType inType)
+{
+    auto found = std::upper_bound(navAids.begin(), navAids.end(), inType, [](XPLMNavType type, const NavAidRecord& navAid) { return type < navAid.type; });
+    return found != navAids.begin() && (found - 1)->type == inType ? (XPLMNavRef)(found - navAids.begin() - 1) : XPLM_NAV_NOT_FOUND;
+}
+
+struct NavAidQuery
+{
+    const char* nameFragment;
+    const char* idFragment;
+    int* frequency;
+    XPLMNavType types;
+
+    bool Matches(const NavAidRecord& navAid) const
+    {
+        return (navAid.type & types) != 0
+            && (frequency == nullptr || navAid.frequency == *frequency)
+            && (nameFragment == nullptr || strstr(stringPool.c_str() + navAid.name, nameFragment) != nullptr)
+            && (idFragment == nullptr || strstr(stringPool.c_str() + navAid.id, idFragment) != nullptr);
+    }
+};
+
+static float GetSquaredDistance(const NavAidRecord& navAid, const float* position)
+{
+    auto dx = navAid.position[0] - position[0];
+    auto dy = navAid.position[1] - position[1];
+    auto dz = navAid.position[2] - position[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+struct NearestSearch
+{
+    const NavAidQuery& query;
+    float position[3];
+    XPLMNavRef nearest = XPLM_NAV_NOT_FOUND;
+    float nearestDistance = 0;
+
+    void Consider(XPLMNavRef ref)
+    {
+        auto& navAid = navAids[ref];
+        if (!query.Matches(navAid))
+            return;
+
+        // Equal distances go to the lower ref, so that the result does not depend on the shape of the tree.
+        auto distance = GetSquaredDistance(navAid, position);
+        if (nearest == XPLM_NAV_NOT_FOUND || distance < nearestDistance || (distance == nearestDistance && ref < nearest))
+        {
+            nearest = ref;
+            nearestDistance = distance;
+        }
+    }
+
+    void Search(int begin, int end)
+    {
+        if (begin >= end)
+            return;
+
+        auto middle = begin + (end - begin) / 2;
+        auto& node = tree[middle];
+        auto dx = node.position[0] - position[0];
+        auto dy = node.position[1] - position[1];
+        auto dz = node.position[2] - position[2];
+        auto distance = dx * dx + dy * dy + dz * dz;
+        if (nearest == XPLM_NAV_NOT_FOUND || distance <= nearestDistance)
+        {
+            Consider(node.ref);
+        }
+
+        // The side of the split with the position first; the other side only if it can be as near.
+        auto offset = position[node.axis] - node.position[node.axis];
+        if (offset < 0)
+        {
+            Search(begin, middle);
+            if (nearest == XPLM_NAV_NOT_FOUND || offset * offset <= nearestDistance)
+                Search(middle + 1, end);
+        }
+        else
+        {
+            Search(middle + 1, end);
+            if (nearest == XPLM_NAV_NOT_FOUND || offset * offset <= nearestDistance)
+                Search(begin, middle);
+        }
+    }
+};
+
+static XPLMNavRef FindNearest(const NavAidQuery& query, float latitude, float longitude)
+{
+    NearestSearch search { query, {} };
+    GetUnitVector(latitude, longitude, search.position);
+    for (XPLMNavType type = 1; type <= xplm_Nav_LatLon; type <<= 1)
+    {
+        if ((query.types & type) == 0)
+            continue;
+
+        auto first = XPLMFindFirstNavAidOfType(type);
+        if (first != XPLM_NAV_NOT_FOUND)
+        {
+            search.Search(first, XPLMFindLastNavAidOfType(type) + 1);
+        }
+    }
+    return search.nearest;
+}
+
+// Without a position, returns the last of the given navaids which matches the query.
+template <typename TRefs>
+static XPLMNavRef FindLast(const NavAidQuery& query, const TRefs& refs)
+{
+    for (auto ref = refs.rbegin(); ref != refs.rend(); ++ref)
+    {
+        if (query.Matches(navAids[*ref]))
+            return *ref;
+    }
+    return XPLM_NAV_NOT_FOUND;
+}
+
+XPLMNavRef XPLMFindNavAid(const char* inNameFragment, const char* inIDFragment, float* inLat, float* inLon, int* inFrequency, XPLMNavType inType)
+{
+    NavAidQuery query { inNameFragment, inIDFragment, inFrequency, inType };
+
+    // With a position, all the navaids which match are ranked by distance, whether their ID matches exactly or not.
+    if (inLat != nullptr && inLon != nullptr)
+        return FindNearest(query, *inLat, *inLon);
+
+    // Otherwise an ID which is matched exactly is looked up in the hash index, and the navaids with that ID are preferred
+    // over the ones which only contain the fragment.
+    if (inIDFragment != nullptr)
+    {
+        auto withId = idIndex.find(std::string_view(inIDFragment));
+        if (withId != idIndex.end())
+        {
+            auto found = FindLast(query, withId->second);
+            if (found != XPLM_NAV_NOT_FOUND)
+                return found;
+        }
+    }
+
+    // The navaids of the same type are consecutive, so only the range of the given types is searched.
+    XPLMNavRef first = (XPLMNavRef)navAids.size(), last = -1;
+    for (XPLMNavType type = 1; type <= xplm_Nav_LatLon; type <<= 1)
+    {
+        if ((inType & type) == 0)
+            continue;
+
+        auto firstOfType = XPLMFindFirstNavAidOfType(type);
+        if (firstOfType != XPLM_NAV_NOT_FOUND)
+        {
+            first = std::min(first, firstOfType);
+            last = std::max(last, XPLMFindLastNavAidOfType(type));
+        }
+    }
+    for (auto ref = last; ref >= first; ref--)
+    {
+        if (query.Matches(navAids[ref]))
+            return ref;
+    }
+    return XPLM_NAV_NOT_FOUND;
+}
+
+static void CopyString(char* dest, const char* value, size_t size)
+{
+    strncpy(dest, value, size - 1);
+    dest[size - 1] = '\0';
+}
+
+void XPLMGetNavAidInfo(XPLMNavRef inRef, XPLMNavType* outType, float* outLatitude, float* outLongitude, float* outHeight, int* outFrequency, float* outHeading, char* outID, char* outName, char* outReg)
+{
+    if (inRef < 0 || inRef >= (XPLMNavRef)navAids.size())
+    {
+        if (outType != nullptr)
+            *outType = xplm_Nav_Unknown;
+        return;
+    }
+
+    auto& navAid = navAids[inRef];
+    if (outType != nullptr)
+        *outType = navAid.type;
+    if (outLatitude != nullptr)
+        *outLatitude = navAid.latitude;
+    if (outLongitude != nullptr)
+        *outLongitude = navAid.longitude;
+    if (outHeight != nullptr)
+        *outHeight = navAid.height;
+    if (outFrequency != nullptr)
+        *outFrequency = navAid.frequency;
+    if (outHeading != nullptr)
+        *outHeading = navAid.heading;
+    // The SDK recommends 32 byte buffers for the IDs and 256 byte buffers for the names.
+    if (outID != nullptr)
+        CopyString(outID, stringPool.c_str() + navAid.id, 32);
+    if (outName != nullptr)
+        CopyString(outName, stringPool.c_str() + navAid.name, 256);
+    // No scenery is loaded, so no navaid is in the local region.
+    if (outReg != nullptr)
+        *outReg = 0;
+}
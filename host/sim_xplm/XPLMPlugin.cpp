@@ -1,4 +1,5 @@
 #include <XPLMPlugin.h>
+#include "Sim.h"
 #if IBM
 #define WINDOWS
 #include <Windows.h>
@@ -11,20 +12,87 @@
 
 namespace fs = std::filesystem;
 
-static std::map<int, fs::path> plugins;
+struct PluginInfo
+{
+    fs::path path;
+    std::string name;
+    std::string signature;
+    std::string description;
+};
+
+static std::map<int, PluginInfo> plugins;
 
 static bool useNativePaths = false;
 
+static XPLMPluginID currentPlugin = 1;
+
 extern "C" XPLM_API void SimRegisterPlugin(int id, const char* path);
+extern "C" XPLM_API void SimSetPluginInfo(int id, const char* name, const char* signature, const char* description);
+extern "C" XPLM_API int SimSetCurrentPlugin(int id);
 
 void SimRegisterPlugin(int id, const char* path)
 {
-    plugins[id] = fs::path(path);
+    plugins[id].path = fs::path(path);
+}
+
+// Records the info returned by XPluginStart.
+void SimSetPluginInfo(int id, const char* name, const char* signature, const char* description)
+{
+    auto& info = plugins[id];
+    info.name = name;
+    info.signature = signature;
+    info.description = description;
+}
+
+// Makes the plugin current while the harness calls its entry points. Returns the previous current plugin.
+int SimSetCurrentPlugin(int id)
+{
+    auto previous = currentPlugin;
+    currentPlugin = id;
+    return previous;
+}
+
+XPLMPluginID SimGetCurrentPlugin()
+{
+    return currentPlugin;
+}
+
+SimPluginScope::SimPluginScope(XPLMPluginID plugin) : previous(currentPlugin)
+{
+    currentPlugin = plugin;
+}
+
+SimPluginScope::~SimPluginScope()
+{
+    currentPlugin = previous;
 }
 
 XPLMPluginID XPLMGetMyID(void)
 {
-	return 1;
+	return currentPlugin;
+}
+
+int XPLMCountPlugins(void)
+{
+    return (int)plugins.size();
+}
+
+XPLMPluginID XPLMGetNthPlugin(int inIndex)
+{
+    if (inIndex < 0 || inIndex >= (int)plugins.size())
+        return XPLM_NO_PLUGIN_ID;
+
+    return std::next(plugins.begin(), inIndex)->first;
+}
+
+XPLMPluginID XPLMFindPluginBySignature(const char* inSignature)
+{
+    for (auto& [id, info] : plugins)
+    {
+        if (info.signature == inSignature)
+            return id;
+    }
+    return XPLM_NO_PLUGIN_ID;
 }
 
 void XPLMGetPluginInfo(
@@ -34,17 +102,30 @@ void XPLMGetPluginInfo(
     char* outSignature,    /* Can be NULL */
     char* outDescription)    /* Can be NULL */
 {
+    auto value = plugins.find(inPlugin);
+    if (value == plugins.cend())
+        return;
+
+    auto& info = value->second;
     if (outFilePath)
     {
-        auto value = plugins.find(inPlugin);
-        if (value != plugins.cend())
-        {
-            std::string path = useNativePaths
-                ? value->second.generic_u8string()
-                : value->second.u8string();
-
-            strcpy(outFilePath, path.c_str());
-        }
+        std::string path = useNativePaths
+            ? info.path.generic_u8string()
+            : info.path.u8string();
+
+        strcpy(outFilePath, path.c_str());
+    }
+    if (outName)
+    {
+        strcpy(outName, info.name.c_str());
+    }
+    if (outSignature)
+    {
+        strcpy(outSignature, info.signature.c_str());
+    }
+    if (outDescription)
+    {
+        strcpy(outDescription, info.description.c_str());
     }
 }
 
@@ -0,0 +1,279 @@
+#include <XPLMProcessing.h>
+#include "Sim.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+// The flight loops run on a virtual clock, which is advanced by the harness through SimRunFrame,
+// so the frames are dispatched as fast as the CPU allows and the runs are deterministic.
+//
+// The scheduled flight loops are kept in priority queues per phase, one keyed on the due cycle
+// for the intervals in frames and one keyed on the due time for the intervals in seconds.
+// Rescheduling or destroying a flight loop bumps its generation, which invalidates its queued entries,
+// so the queues never have to be searched. For the same reason the flight loops are never freed;
+// the destroyed ones are reused with a new generation.
+
+struct FlightLoop
+{
+    XPLMPluginID plugin = XPLM_NO_PLUGIN_ID;
+    XPLMFlightLoopPhaseType phase = xplm_FlightLoop_Phase_BeforeFlightModel;
+    XPLMFlightLoop_f callback = nullptr;
+    void* refcon = nullptr;
+    bool legacy = false;
+    bool destroyed = false;
+    // The order of registration, which is also the order of the callbacks due in the same frame.
+    uint64_t sequence = 0;
+    uint64_t generation = 0;
+    double lastCallTime = 0;
+    int lastCallCycle = 0;
+};
+
+template <typename TKey>
+struct QueueEntry
+{
+    TKey due;
+    uint64_t sequence;
+    uint64_t generation;
+    FlightLoop* loop;
+
+    bool operator>(const QueueEntry& other) const
+    {
+        return due != other.due ? due > other.due : sequence > other.sequence;
+    }
+};
+
+template <typename TKey>
+using Queue = std::priority_queue<QueueEntry<TKey>, std::vector<QueueEntry<TKey>>, std::greater<QueueEntry<TKey>>>;
+
+struct PhaseQueues
+{
+    Queue<int> cycles;
+    Queue<double> seconds;
+};
+
+static std::deque<FlightLoop> flightLoops;
+static std::vector<FlightLoop*> freeFlightLoops;
+// The flight loops destroyed during the dispatch, which are reused only after it.
+static std::vector<FlightLoop*> destroyedFlightLoops;
+static PhaseQueues phases[2];
+static uint64_t nextSequence = 0;
+static double elapsedTime = 0;
+static double lastFrameTime = 0;
+static int cycleNumber = 0;
+static bool dispatching = false;
+
+static PhaseQueues& GetQueues(XPLMFlightLoopPhaseType phase)
+{
+    return phases[phase == xplm_FlightLoop_Phase_AfterFlightModel ? 1 : 0];
+}
+
+static void Schedule(FlightLoop* loop, float interval, bool relativeToNow)
+{
+    // Any previously queued entry of the flight loop becomes stale.
+    loop->generation++;
+    if (interval == 0 || loop->destroyed)
+        return;
+
+    auto& queues = GetQueues(loop->phase);
+    if (interval < 0)
+    {
+        auto frames = std::max(1, (int)-interval);
+        auto base = relativeToNow ? cycleNumber : loop->lastCallCycle;
+        queues.cycles.push({ base + frames, loop->sequence, loop->generation, loop });
+    }
+    else
+    {
+        auto base = relativeToNow ? elapsedTime : loop->lastCallTime;
+        queues.seconds.push({ base + interval, loop->sequence, loop->generation, loop });
+    }
+}
+
+static FlightLoop* AddFlightLoop(XPLMFlightLoopPhaseType phase, XPLMFlightLoop_f callback, void* refcon, bool legacy)
+{
+    FlightLoop* loop;
+    if (!freeFlightLoops.empty())
+    {
+        loop = freeFlightLoops.back();
+        freeFlightLoops.pop_back();
+    }
+    else
+    {
+        loop = &flightLoops.emplace_back();
+    }
+
+    loop->plugin = SimGetCurrentPlugin();
+    loop->phase = phase;
+    loop->callback = callback;
+    loop->refcon = refcon;
+    loop->legacy = legacy;
+    loop->destroyed = false;
+    loop->sequence = nextSequence++;
+    loop->lastCallTime = elapsedTime;
+    loop->lastCallCycle = cycleNumber;
+    return loop;
+}
+
+static FlightLoop* FindLegacyFlightLoop(XPLMFlightLoop_f callback, void* refcon)
+{
+    for (auto& loop : flightLoops)
+    {
+        if (loop.legacy && !loop.destroyed && loop.callback == callback && loop.refcon == refcon)
+            return &loop;
+    }
+    return nullptr;
+}
+
+static void DestroyFlightLoop(FlightLoop* loop)
+{
+    loop->destroyed = true;
+    loop->generation++;
+    // A flight loop may be destroyed from a callback, while it is still in the list of the due ones.
+    (dispatching ? destroyedFlightLoops : freeFlightLoops).push_back(loop);
+}
+
+template <typename TKey>
+static void CollectDue(Queue<TKey>& queue, TKey now, std::vector<QueueEntry<TKey>>& due)
+{
+    while (!queue.empty() && queue.top().due <= now)
+    {
+        auto& entry = queue.top();
+        if (entry.generation == entry.loop->generation)
+        {
+            due.push_back(entry);
+        }
+        queue.pop();
+    }
+}
+
+static int DispatchPhase(PhaseQueues& queues, const char* phaseName, float elapsedSinceLastFlightLoop)
+{
+    // The buffers are reused, so that a frame does not allocate. The dispatch is not reentrant.
+    static std::vector<QueueEntry<int>> dueCycles;
+    static std::vector<QueueEntry<double>> dueSeconds;
+    static std::vector<std::tuple<uint64_t, uint64_t, FlightLoop*>> due;
+    dueCycles.clear();
+    dueSeconds.clear();
+    due.clear();
+    CollectDue(queues.cycles, cycleNumber, dueCycles);
+    CollectDue(queues.seconds, elapsedTime, dueSeconds);
+
+    for (auto& entry : dueCycles)
+        due.emplace_back(entry.sequence, entry.generation, entry.loop);
+    for (auto& entry : dueSeconds)
+        due.emplace_back(entry.sequence, entry.generation, entry.loop);
+    std::sort(due.begin(), due.end());
+
+    int dispatched = 0;
+    for (auto& [sequence, generation, loop] : due)
+    {
+        // An earlier callback of this frame may have destroyed or rescheduled the flight loop.
+        if (loop->generation != generation)
+            continue;
+
+        auto sinceLastCall = (float)(elapsedTime - loop->lastCallTime);
+        loop->lastCallTime = elapsedTime;
+        loop->lastCallCycle = cycleNumber;
+        float interval;
+        {
+            SimCallbackScope scope(loop->plugin, phaseName);
+            interval = loop->callback(sinceLastCall, elapsedSinceLastFlightLoop, cycleNumber, loop->refcon);
+        }
+        dispatched++;
+
+        // The callback may have rescheduled itself, which takes precedence over the returned interval.
+        if (loop->generation == generation)
+        {
+            Schedule(loop, interval, true);
+        }
+    }
+    return dispatched;
+}
+
+extern "C" XPLM_API int SimRunFrame(float frameSeconds);
+
+// Advances the virtual clock by one frame, sends the continue phase to the held commands and dispatches the flight loops which are due.
+// Returns the number of callbacks dispatched in the frame.
+int SimRunFrame(float frameSeconds)
+{
+    cycleNumber++;
+    elapsedTime += frameSeconds;
+    auto sinceLastFlightLoop = (float)(elapsedTime - lastFrameTime);
+    lastFrameTime = elapsedTime;
+
+    SimTraceBeginFrame();
+    int dispatched = SimContinueHeldCommands();
+    dispatching = true;
+    dispatched += DispatchPhase(phases[0], "flight_loop_before_fm", sinceLastFlightLoop);
+    dispatched += DispatchPhase(phases[1], "flight_loop_after_fm", sinceLastFlightLoop);
+    dispatching = false;
+    SimTraceEndFrame();
+
+    freeFlightLoops.insert(freeFlightLoops.end(), destroyedFlightLoops.begin(), destroyedFlightLoops.end());
+    destroyedFlightLoops.clear();
+    return dispatched;
+}
+
+float XPLMGetElapsedTime(void)
+{
+    return (float)elapsedTime;
+}
+
+int XPLMGetCycleNumber(void)
+{
+    return cycleNumber;
+}
+
+void XPLMRegisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, float inInterval, void* inRefcon)
+{
+    auto loop = AddFlightLoop(xplm_FlightLoop_Phase_BeforeFlightModel, inFlightLoop, inRefcon, true);
+    Schedule(loop, inInterval, true);
+}
+
+void XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f inFlightLoop, void* inRefcon)
+{
+    auto loop = FindLegacyFlightLoop(inFlightLoop, inRefcon);
+    if (loop != nullptr)
+    {
+        DestroyFlightLoop(loop);
+    }
+}
+
+void XPLMSetFlightLoopCallbackInterval(XPLMFlightLoop_f inFlightLoop, float inInterval, int inRelativeToNow, void* inRefcon)
+{
+    auto loop = FindLegacyFlightLoop(inFlightLoop, inRefcon);
+    if (loop != nullptr)
+    {
+        Schedule(loop, inInterval, inRelativeToNow != 0);
+    }
+}
+
+XPLMFlightLoopID XPLMCreateFlightLoop(XPLMCreateFlightLoop_t* inParams)
+{
+    if (inParams == nullptr || inParams->callbackFunc == nullptr)
+        return nullptr;
+
+    return AddFlightLoop(inParams->phase, inParams->callbackFunc, inParams->refcon, false);
+}
+
+void XPLMDestroyFlightLoop(XPLMFlightLoopID inFlightLoopID)
+{
+    auto loop = (FlightLoop*)inFlightLoopID;
+    if (loop != nullptr && !loop->destroyed)
+    {
+        DestroyFlightLoop(loop);
+    }
+}
+
+void XPLMScheduleFlightLoop(XPLMFlightLoopID inFlightLoopID, float inInterval, int inRelativeToNow)
+{
+    auto loop = (FlightLoop*)inFlightLoopID;
+    if (loop != nullptr && !loop->destroyed)
+    {
+        Schedule(loop, inInterval, inRelativeToNow != 0);
+    }
+}
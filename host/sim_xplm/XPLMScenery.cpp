@@ -0,0 +1,347 @@
+#include <XPLMScenery.h>
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// The terrain, loaded from a heightfield tile set by SimLoadTerrain, and the terrain probes over it.
+//
+// The tile set file is little endian: a header is followed by a directory of the tiles and then by their samples.
+// Each tile covers one degree of latitude and longitude from its south-west corner, with samples x samples heights
+// in meters above the sea level, as floats in rows from the south to the north and columns from the west to the east.
+// The edge samples of the neighboring tiles are duplicated, like in the SRTM tiles.
+//
+// The objects are not drawn, so they are only handles, shared by the loads of the same path and counted.
+//
+// The local coordinates are a flat projection around the local reference point: x is to the east, y is up
+// and z is to the south, in meters, and y = 0 is the sea level. The terrain at or below the sea level is water.
+
+struct TileSetHeader
+{
+    char magic[4]; // "XPHF"
+    uint32_t version;
+    uint32_t tileCount;
+    uint32_t reserved;
+};
+
+struct TileSetEntry
+{
+    int32_t latitude;
+    int32_t longitude;
+    uint32_t samples;
+    uint32_t reserved;
+    // The offset of the samples from the start of the file.
+    uint64_t offset;
+};
+
+struct Tile
+{
+    const float* heights;
+    int samples;
+};
+
+struct Probe
+{
+    XPLMProbeType type;
+};
+
+// The most samples along a tile edge, more than the 3601 of the one arc second SRTM tiles.
+static const uint32_t MaxTileSamples = 16384;
+
+static const double MetersPerDegree = 6378137.0 * 3.14159265358979323846 / 180;
+
+static std::unique_ptr<MappedFile> terrainFile;
+static std::vector<Tile> tiles;
+// The index of the tile of each one degree cell, or -1, from the cell of (-90, -180).
+static std::vector<int> tileIndex;
+static double referenceLatitude;
+static double referenceLongitude;
+static double metersPerDegreeLongitude = MetersPerDegree;
+
+static int GetCell(int latitude, int longitude)
+{
+    return (latitude + 90) * 360 + (longitude + 180);
+}
+
+extern "C" XPLM_API void SimSetLocalReference(double latitude, double longitude);
+
+// Sets the point at the origin of the local coordinates.
+void SimSetLocalReference(double latitude, double longitude)
+{
+    referenceLatitude = latitude;
+    referenceLongitude = longitude;
+    metersPerDegreeLongitude = MetersPerDegree * std::cos(latitude * 3.14159265358979323846 / 180);
+}
+
+extern "C" XPLM_API int SimLoadTerrain(const char* path);
+
+// Loads the terrain from a heightfield tile set, replacing the loaded one, and moves the local reference point
+// to the center of the first tile. Returns the number of the tiles loaded, or -1 if the file cannot be read.
+int SimLoadTerrain(const char* path)
+{
+    terrainFile.reset();
+    tiles.clear();
+    tileIndex.assign(180 * 360, -1);
+
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(path) || file->length() < sizeof(TileSetHeader))
+        return -1;
+
+    auto data = file->begin();
+    auto header = (const TileSetHeader*)data;
+    if (memcmp(header->magic, "XPHF", 4) != 0 || header->version != 1
+        || file->length() < sizeof(TileSetHeader) + (uint64_t)header->tileCount * sizeof(TileSetEntry))
+        return -1;
+
+    // The entries are all checked before any tile is added, so a bad file leaves no tiles pointing into it.
+    auto entries = (const TileSetEntry*)(data + sizeof(TileSetHeader));
+    for (uint32_t i = 0; i < header->tileCount; i++)
+    {
+        auto& entry = entries[i];
+        if (entry.samples < 2 || entry.samples > MaxTileSamples || entry.offset % sizeof(float) != 0
+            || entry.latitude < -90 || entry.latitude >= 90 || entry.longitude < -180 || entry.longitude >= 180)
+            return -1;
+
+        auto size = (uint64_t)entry.samples * entry.samples * sizeof(float);
+        if (size > file->length() || entry.offset > file->length() - size)
+            return -1;
+    }
+
+    for (uint32_t i = 0; i < header->tileCount; i++)
+    {
+        auto& entry = entries[i];
+        tileIndex[GetCell(entry.latitude, entry.longitude)] = (int)tiles.size();
+        tiles.push_back(Tile { (const float*)(data + entry.offset), (int)entry.samples });
+    }
+
+    if (header->tileCount > 0)
+    {
+        SimSetLocalReference(entries[0].latitude + 0.5, entries[0].longitude + 0.5);
+    }
+    terrainFile = std::move(file);
+    return (int)tiles.size();
+}
+
+XPLMProbeRef XPLMCreateProbe(XPLMProbeType inProbeType)
+{
+    return new Probe { inProbeType };
+}
+
+void XPLMDestroyProbe(XPLMProbeRef inProbe)
+{
+    delete (Probe*)inProbe;
+}
+
+// The points are interpolated in groups of this many: the samples are gathered for each point,
+// and the interpolation and the normals are computed for the whole group at once.
+#define PROBE_LANES 4
+
+struct ProbeLanes
+{
+    // The four samples around each point, and the position of the point between them.
+    float h00[PROBE_LANES], h01[PROBE_LANES], h10[PROBE_LANES], h11[PROBE_LANES];
+    float fx[PROBE_LANES], fz[PROBE_LANES];
+    // The size of a sample step in meters, to the east and to the north.
+    float stepX[PROBE_LANES], stepZ[PROBE_LANES];
+    // The results: the height and the normal.
+    float height[PROBE_LANES], normalX[PROBE_LANES], normalY[PROBE_LANES], normalZ[PROBE_LANES];
+};
+
+// Finds the samples around the point. Returns false if there is no terrain under the point.
+static bool GatherSamples(float x, float z, ProbeLanes& lanes, int lane)
+{
+    auto latitude = referenceLatitude - z / MetersPerDegree;
+    auto longitude = referenceLongitude + x / metersPerDegreeLongitude;
+    auto cellLatitude = (int)std::floor(latitude);
+    auto cellLongitude = (int)std::floor(longitude);
+    if (cellLatitude < -90 || cellLatitude >= 90 || cellLongitude < -180 || cellLongitude >= 180 || tileIndex.empty())
+        return false;
+
+    auto index = tileIndex[GetCell(cellLatitude, cellLongitude)];
+    if (index < 0)
+        return false;
+
+    auto& tile = tiles[index];
+    auto steps = tile.samples - 1;
+    auto row = (latitude - cellLatitude) * steps;
+    auto column = (longitude - cellLongitude) * steps;
+    auto row0 = std::min((int)row, steps - 1);
+    auto column0 = std::min((int)column, steps - 1);
+    auto south = tile.heights + (size_t)row0 * tile.samples + column0;
+    auto north = south + tile.samples;
+
+    lanes.h00[lane] = south[0];
+    lanes.h10[lane] = south[1];
+    lanes.h01[lane] = north[0];
+    lanes.h11[lane] = north[1];
+    lanes.fx[lane] = (float)(column - column0);
+    lanes.fz[lane] = (float)(row - row0);
+    lanes.stepX[lane] = (float)(metersPerDegreeLongitude / steps);
+    lanes.stepZ[lane] = (float)(MetersPerDegree / steps);
+    return true;
+}
+
+// Interpolates the heights bilinearly, and computes the normals from the gradients of the interpolation.
+static void Interpolate(ProbeLanes& lanes)
+{
+#if SIM_SSE2
+    auto h00 = _mm_loadu_ps(lanes.h00);
+    auto h10 = _mm_loadu_ps(lanes.h10);
+    auto h01 = _mm_loadu_ps(lanes.h01);
+    auto h11 = _mm_loadu_ps(lanes.h11);
+    auto fx = _mm_loadu_ps(lanes.fx);
+    auto fz = _mm_loadu_ps(lanes.fz);
+
+    auto dx = _mm_sub_ps(h10, h00);
+    auto dz = _mm_sub_ps(h01, h00);
+    auto dxz = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(h00, h11), h10), h01);
+    auto height = _mm_add_ps(h00, _mm_add_ps(_mm_mul_ps(fx, dx), _mm_mul_ps(fz, _mm_add_ps(dz, _mm_mul_ps(fx, dxz)))));
+
+    // The slopes to the east and to the north; the normal is (-east, 1, north) in the local coordinates, since z is to the south.
+    auto east = _mm_div_ps(_mm_add_ps(dx, _mm_mul_ps(fz, dxz)), _mm_loadu_ps(lanes.stepX));
+    auto north = _mm_div_ps(_mm_add_ps(dz, _mm_mul_ps(fx, dxz)), _mm_loadu_ps(lanes.stepZ));
+    auto one = _mm_set1_ps(1);
+    auto length = _mm_sqrt_ps(_mm_add_ps(one, _mm_add_ps(_mm_mul_ps(east, east), _mm_mul_ps(north, north))));
+    auto scale = _mm_div_ps(one, length);
+
+    _mm_storeu_ps(lanes.height, height);
+    _mm_storeu_ps(lanes.normalX, _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(east, scale)));
+    _mm_storeu_ps(lanes.normalY, scale);
+    _mm_storeu_ps(lanes.normalZ, _mm_mul_ps(north, scale));
+#else
+    for (int i = 0; i < PROBE_LANES; i++)
+    {
+        auto dx = lanes.h10[i] - lanes.h00[i];
+        auto dz = lanes.h01[i] - lanes.h00[i];
+        auto dxz = lanes.h00[i] + lanes.h11[i] - lanes.h10[i] - lanes.h01[i];
+        lanes.height[i] = lanes.h00[i] + lanes.fx[i] * dx + lanes.fz[i] * (dz + lanes.fx[i] * dxz);
+
+        auto east = (dx + lanes.fz[i] * dxz) / lanes.stepX[i];
+        auto north = (dz + lanes.fx[i] * dxz) / lanes.stepZ[i];
+        auto scale = 1 / std::sqrt(1 + east * east + north * north);
+        lanes.normalX[i] = -east * scale;
+        lanes.normalY[i] = scale;
+        lanes.normalZ[i] = north * scale;
+    }
+#endif
+}
+
+extern "C" XPLM_API int SimProbeTerrainBatch(XPLMProbeRef probe, const float* points, int count, XPLMProbeInfo_t* infos, XPLMProbeResult* results);
+
+// Probes the terrain under count points, given as x, y, z triples in the local coordinates, like XPLMProbeTerrainXYZ does
+// for each of them. The structSize of every info must be set. Returns the number of the points which hit the terrain.
+int SimProbeTerrainBatch(XPLMProbeRef probe, const float* points, int count, XPLMProbeInfo_t* infos, XPLMProbeResult* results)
+{
+    // Only the probes along the Y axis are supported by X-Plane.
+    if (probe == nullptr || ((Probe*)probe)->type != xplm_ProbeY)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            results[i] = xplm_ProbeError;
+        }
+        return 0;
+    }
+
+    int hits = 0;
+    for (int first = 0; first < count; first += PROBE_LANES)
+    {
+        ProbeLanes lanes {};
+        bool hit[PROBE_LANES] {};
+        auto lastLane = std::min(PROBE_LANES, count - first);
+        for (int lane = 0; lane < lastLane; lane++)
+        {
+            auto point = points + (first + lane) * 3;
+            hit[lane] = infos[first + lane].structSize == sizeof(XPLMProbeInfo_t) && GatherSamples(point[0], point[2], lanes, lane);
+            // The unused lanes are flat, so that they do not divide by zero.
+            if (!hit[lane])
+            {
+                lanes.stepX[lane] = lanes.stepZ[lane] = 1;
+            }
+        }
+        for (int lane = lastLane; lane < PROBE_LANES; lane++)
+        {
+            lanes.stepX[lane] = lanes.stepZ[lane] = 1;
+        }
+
+        Interpolate(lanes);
+
+        for (int lane = 0; lane < lastLane; lane++)
+        {
+            auto i = first + lane;
+            if (!hit[lane])
+            {
+                results[i] = infos[i].structSize == sizeof(XPLMProbeInfo_t) ? xplm_ProbeMissed : xplm_ProbeError;
+                continue;
+            }
+
+            auto& info = infos[i];
+            info.locationX = points[i * 3];
+            info.locationY = lanes.height[lane];
+            info.locationZ = points[i * 3 + 2];
+            info.normalX = lanes.normalX[lane];
+            info.normalY = lanes.normalY[lane];
+            info.normalZ = lanes.normalZ[lane];
+            info.velocityX = info.velocityY = info.velocityZ = 0;
+            info.is_wet = lanes.height[lane] <= 0 ? 1 : 0;
+            results[i] = xplm_ProbeHitTerrain;
+            hits++;
+        }
+    }
+    return hits;
+}
+
+XPLMProbeResult XPLMProbeTerrainXYZ(XPLMProbeRef inProbe, float inX, float inY, float inZ, XPLMProbeInfo_t* outInfo)
+{
+    float point[3] = { inX, inY, inZ };
+    XPLMProbeResult result;
+    SimProbeTerrainBatch(inProbe, point, 1, outInfo, &result);
+    return result;
+}
+
+struct SceneryObject
+{
+    std::string path;
+    int references;
+};
+
+static std::unordered_map<std::string, SceneryObject*> objects;
+
+XPLMObjectRef XPLMLoadObject(const char* inPath)
+{
+    if (inPath == nullptr || *inPath == '\0')
+        return nullptr;
+
+    auto& object = objects[inPath];
+    if (object == nullptr)
+    {
+        object = new SceneryObject { inPath, 0 };
+    }
+    object->references++;
+    return object;
+}
+
+void XPLMLoadObjectAsync(const char* inPath, XPLMObjectLoaded_f inCallback, void* inRefcon)
+{
+    inCallback(XPLMLoadObject(inPath), inRefcon);
+}
+
+void XPLMUnloadObject(XPLMObjectRef inObject)
+{
+    auto object = (SceneryObject*)inObject;
+    if (object != nullptr && --object->references == 0)
+    {
+        objects.erase(object->path);
+        delete object;
+    }
+}
@@ -0,0 +1,448 @@
+#include <XPLMDisplay.h>
+#include "Sim.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// The window API of XPLMDisplay.h. There is one 1920x1080 monitor at the origin of the global desktop, with one
+// boxel per pixel, so the global and the OS coordinates are the same, and the mouse stays in the middle of the screen.
+//
+// The windows are kept in the z-order: by layer, and back to front in a layer. SimDrawWindows is called by SimDrawFrame
+// in the window phase, and calls the draw functions of the visible windows in that order. There is no GL context,
+// so a window costs only the time spent in its draw function, which is recorded per plugin like the draw callbacks.
+//
+// The windows may be created, destroyed and reordered while they are drawn. The windows are drawn in the order
+// of the frame start, the new windows are drawn from the next frame on, and the destroyed ones are only marked
+// as removed until the frame ends.
+
+static const int screenWidth = 1920;
+static const int screenHeight = 1080;
+
+struct Window
+{
+    XPLMPluginID plugin;
+    XPLMDrawWindow_f drawWindowFunc;
+    XPLMHandleMouseClick_f handleMouseClickFunc;
+    XPLMHandleMouseClick_f handleRightClickFunc;
+    XPLMHandleKey_f handleKeyFunc;
+    XPLMHandleCursor_f handleCursorFunc;
+    XPLMHandleMouseWheel_f handleMouseWheelFunc;
+    void* refcon;
+    XPLMWindowLayer layer;
+    XPLMWindowDecoration decoration;
+    int left, top, right, bottom;
+    int vrWidth = 0, vrHeight = 0;
+    float gravity[4] = { 0, 1, 0, 1 };
+    int minWidth = 0, minHeight = 0, maxWidth = 0, maxHeight = 0;
+    XPLMWindowPositioningMode positioningMode = xplm_WindowPositionFree;
+    std::string title;
+    bool visible;
+    bool removed = false;
+};
+
+static std::vector<std::unique_ptr<Window>> windows;
+// The windows which have not been destroyed. The IDs are checked against it before they are dereferenced,
+// since a destroyed window may already be freed.
+static std::unordered_set<const Window*> liveWindows;
+// The windows of the frame being drawn, reused between the frames.
+static std::vector<Window*> drawOrder;
+static bool drawingWindows = false;
+// The window with the keyboard focus, or null if X-Plane has it.
+static Window* keyboardFocus = nullptr;
+
+static Window* GetWindow(XPLMWindowID id)
+{
+    auto window = (Window*)id;
+    return liveWindows.count(window) != 0 ? window : nullptr;
+}
+
+// Places the window at the front of its layer.
+static void PlaceInFront(std::unique_ptr<Window> window)
+{
+    auto layer = window->layer;
+    auto position = std::find_if(windows.begin(), windows.end(), [=](auto& w) { return w->layer > layer; });
+    windows.insert(position, std::move(window));
+}
+
+static XPLMWindowID CreateWindow(Window&& window)
+{
+    auto created = std::make_unique<Window>(std::move(window));
+    auto id = created.get();
+    liveWindows.insert(id);
+    PlaceInFront(std::move(created));
+    return id;
+}
+
+XPLMWindowID XPLMCreateWindowEx(XPLMCreateWindow_t* inParams)
+{
+    if (inParams == nullptr)
+        return nullptr;
+
+    // The fields added by the later SDK versions are only read if the structure is large enough to have them.
+    auto has = [=](size_t offset) { return (size_t)inParams->structSize >= offset + sizeof(int); };
+
+    Window window {};
+    window.plugin = SimGetCurrentPlugin();
+    window.drawWindowFunc = inParams->drawWindowFunc;
+    window.handleMouseClickFunc = inParams->handleMouseClickFunc;
+    window.handleKeyFunc = inParams->handleKeyFunc;
+    window.handleCursorFunc = inParams->handleCursorFunc;
+    window.handleMouseWheelFunc = inParams->handleMouseWheelFunc;
+    window.refcon = inParams->refcon;
+    window.decoration = has(offsetof(XPLMCreateWindow_t, decorateAsFloatingWindow)) ? inParams->decorateAsFloatingWindow : xplm_WindowDecorationNone;
+    window.layer = has(offsetof(XPLMCreateWindow_t, layer)) ? inParams->layer : xplm_WindowLayerFloatingWindows;
+    window.handleRightClickFunc = has(offsetof(XPLMCreateWindow_t, handleRightClickFunc)) ? inParams->handleRightClickFunc : nullptr;
+    window.left = inParams->left;
+    window.top = inParams->top;
+    window.right = inParams->right;
+    window.bottom = inParams->bottom;
+    window.visible = inParams->visible != 0;
+    return CreateWindow(std::move(window));
+}
+
+XPLMWindowID XPLMCreateWindow(int inLeft, int inTop, int inRight, int inBottom, int inIsVisible,
+    XPLMDrawWindow_f inDrawCallback, XPLMHandleKey_f inKeyCallback, XPLMHandleMouseClick_f inMouseCallback, void* inRefcon)
+{
+    // The legacy windows are always in the flight overlay layer.
+    Window window {};
+    window.plugin = SimGetCurrentPlugin();
+    window.drawWindowFunc = inDrawCallback;
+    window.handleMouseClickFunc = inMouseCallback;
+    window.handleKeyFunc = inKeyCallback;
+    window.refcon = inRefcon;
+    window.layer = xplm_WindowLayerFlightOverlay;
+    window.decoration = xplm_WindowDecorationNone;
+    window.left = inLeft;
+    window.top = inTop;
+    window.right = inRight;
+    window.bottom = inBottom;
+    window.visible = inIsVisible != 0;
+    return CreateWindow(std::move(window));
+}
+
+static void EraseWindow(Window* window)
+{
+    windows.erase(std::find_if(windows.begin(), windows.end(), [=](auto& w) { return w.get() == window; }));
+}
+
+void XPLMDestroyWindow(XPLMWindowID inWindowID)
+{
+    auto window = GetWindow(inWindowID);
+    if (window == nullptr)
+        return;
+
+    if (keyboardFocus == window)
+    {
+        keyboardFocus = nullptr;
+    }
+
+    window->removed = true;
+    liveWindows.erase(window);
+    if (!drawingWindows)
+    {
+        EraseWindow(window);
+    }
+}
+
+int SimDrawWindows()
+{
+    drawOrder.clear();
+    for (auto& window : windows)
+    {
+        drawOrder.push_back(window.get());
+    }
+
+    int called = 0;
+    drawingWindows = true;
+    for (auto window : drawOrder)
+    {
+        if (window->removed || !window->visible || window->drawWindowFunc == nullptr)
+            continue;
+
+        SimCallbackScope scope(window->plugin, "draw_window_func");
+        window->drawWindowFunc(window, window->refcon);
+        called++;
+    }
+    drawingWindows = false;
+
+    windows.erase(std::remove_if(windows.begin(), windows.end(), [](auto& w) { return w->removed; }), windows.end());
+    return called;
+}
+
+void XPLMGetScreenSize(int* outWidth, int* outHeight)
+{
+    if (outWidth != nullptr)
+        *outWidth = screenWidth;
+    if (outHeight != nullptr)
+        *outHeight = screenHeight;
+}
+
+void XPLMGetScreenBoundsGlobal(int* outLeft, int* outTop, int* outRight, int* outBottom)
+{
+    if (outLeft != nullptr)
+        *outLeft = 0;
+    if (outTop != nullptr)
+        *outTop = screenHeight;
+    if (outRight != nullptr)
+        *outRight = screenWidth;
+    if (outBottom != nullptr)
+        *outBottom = 0;
+}
+
+void XPLMGetAllMonitorBoundsGlobal(XPLMReceiveMonitorBoundsGlobal_f inMonitorBoundsCallback, void* inRefcon)
+{
+    if (inMonitorBoundsCallback != nullptr)
+    {
+        inMonitorBoundsCallback(0, 0, screenHeight, screenWidth, 0, inRefcon);
+    }
+}
+
+void XPLMGetAllMonitorBoundsOS(XPLMReceiveMonitorBoundsOS_f inMonitorBoundsCallback, void* inRefcon)
+{
+    if (inMonitorBoundsCallback != nullptr)
+    {
+        inMonitorBoundsCallback(0, 0, screenHeight, screenWidth, 0, inRefcon);
+    }
+}
+
+void XPLMGetMouseLocation(int* outX, int* outY)
+{
+    if (outX != nullptr)
+        *outX = screenWidth / 2;
+    if (outY != nullptr)
+        *outY = screenHeight / 2;
+}
+
+void XPLMGetMouseLocationGlobal(int* outX, int* outY)
+{
+    XPLMGetMouseLocation(outX, outY);
+}
+
+static void GetGeometry(Window* window, int* outLeft, int* outTop, int* outRight, int* outBottom)
+{
+    if (outLeft != nullptr)
+        *outLeft = window != nullptr ? window->left : 0;
+    if (outTop != nullptr)
+        *outTop = window != nullptr ? window->top : 0;
+    if (outRight != nullptr)
+        *outRight = window != nullptr ? window->right : 0;
+    if (outBottom != nullptr)
+        *outBottom = window != nullptr ? window->bottom : 0;
+}
+
+static void SetGeometry(Window* window, int inLeft, int inTop, int inRight, int inBottom)
+{
+    window->left = inLeft;
+    window->top = inTop;
+    window->right = inRight;
+    window->bottom = inBottom;
+}
+
+void XPLMGetWindowGeometry(XPLMWindowID inWindowID, int* outLeft, int* outTop, int* outRight, int* outBottom)
+{
+    GetGeometry(GetWindow(inWindowID), outLeft, outTop, outRight, outBottom);
+}
+
+void XPLMSetWindowGeometry(XPLMWindowID inWindowID, int inLeft, int inTop, int inRight, int inBottom)
+{
+    // Only the floating windows are positioned in the global desktop.
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr && window->positioningMode != xplm_WindowPopOut && window->positioningMode != xplm_WindowVR)
+    {
+        SetGeometry(window, inLeft, inTop, inRight, inBottom);
+    }
+}
+
+void XPLMGetWindowGeometryOS(XPLMWindowID inWindowID, int* outLeft, int* outTop, int* outRight, int* outBottom)
+{
+    auto window = GetWindow(inWindowID);
+    GetGeometry(window != nullptr && window->positioningMode == xplm_WindowPopOut ? window : nullptr, outLeft, outTop, outRight, outBottom);
+}
+
+void XPLMSetWindowGeometryOS(XPLMWindowID inWindowID, int inLeft, int inTop, int inRight, int inBottom)
+{
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr && window->positioningMode == xplm_WindowPopOut)
+    {
+        SetGeometry(window, inLeft, inTop, inRight, inBottom);
+    }
+}
+
+void XPLMGetWindowGeometryVR(XPLMWindowID inWindowID, int* outWidthBoxels, int* outHeightBoxels)
+{
+    auto window = GetWindow(inWindowID);
+    auto inVR = window != nullptr && window->positioningMode == xplm_WindowVR;
+    if (outWidthBoxels != nullptr)
+        *outWidthBoxels = inVR ? window->vrWidth : 0;
+    if (outHeightBoxels != nullptr)
+        *outHeightBoxels = inVR ? window->vrHeight : 0;
+}
+
+void XPLMSetWindowGeometryVR(XPLMWindowID inWindowID, int widthBoxels, int heightBoxels)
+{
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr && window->positioningMode == xplm_WindowVR)
+    {
+        window->vrWidth = widthBoxels;
+        window->vrHeight = heightBoxels;
+    }
+}
+
+int XPLMGetWindowIsVisible(XPLMWindowID inWindowID)
+{
+    auto window = GetWindow(inWindowID);
+    return window != nullptr && window->visible;
+}
+
+void XPLMSetWindowIsVisible(XPLMWindowID inWindowID, int inIsVisible)
+{
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr)
+    {
+        window->visible = inIsVisible != 0;
+    }
+}
+
+int XPLMWindowIsPoppedOut(XPLMWindowID inWindowID)
+{
+    auto window = GetWindow(inWindowID);
+    return window != nullptr && window->positioningMode == xplm_WindowPopOut;
+}
+
+int XPLMWindowIsInVR(XPLMWindowID inWindowID)
+{
+    auto window = GetWindow(inWindowID);
+    return window != nullptr && window->positioningMode == xplm_WindowVR;
+}
+
+void XPLMSetWindowGravity(XPLMWindowID inWindowID, float inLeftGravity, float inTopGravity, float inRightGravity, float inBottomGravity)
+{
+    // The screen never resizes, so the gravity is only kept.
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr)
+    {
+        window->gravity[0] = inLeftGravity;
+        window->gravity[1] = inTopGravity;
+        window->gravity[2] = inRightGravity;
+        window->gravity[3] = inBottomGravity;
+    }
+}
+
+void XPLMSetWindowResizingLimits(XPLMWindowID inWindowID, int inMinWidthBoxels, int inMinHeightBoxels, int inMaxWidthBoxels, int inMaxHeightBoxels)
+{
+    // There is no user to resize the windows, so the limits are only kept.
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr)
+    {
+        window->minWidth = inMinWidthBoxels;
+        window->minHeight = inMinHeightBoxels;
+        window->maxWidth = inMaxWidthBoxels;
+        window->maxHeight = inMaxHeightBoxels;
+    }
+}
+
+void XPLMSetWindowPositioningMode(XPLMWindowID inWindowID, XPLMWindowPositioningMode inPositioningMode, int inMonitorIndex)
+{
+    // The only monitor is 0, and a negative index is the main monitor.
+    auto window = GetWindow(inWindowID);
+    if (window == nullptr || inMonitorIndex > 0)
+        return;
+
+    auto width = window->right - window->left;
+    auto height = window->top - window->bottom;
+    switch (inPositioningMode)
+    {
+    case xplm_WindowCenterOnMonitor:
+        window->left = (screenWidth - width) / 2;
+        window->bottom = (screenHeight - height) / 2;
+        window->right = window->left + width;
+        window->top = window->bottom + height;
+        break;
+    case xplm_WindowFullScreenOnMonitor:
+    case xplm_WindowFullScreenOnAllMonitors:
+        SetGeometry(window, 0, screenHeight, screenWidth, 0);
+        break;
+    case xplm_WindowVR:
+        if (window->positioningMode != xplm_WindowVR)
+        {
+            window->vrWidth = width;
+            window->vrHeight = height;
+        }
+        break;
+    }
+    window->positioningMode = inPositioningMode;
+}
+
+void XPLMSetWindowTitle(XPLMWindowID inWindowID, const char* inWindowTitle)
+{
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr)
+    {
+        window->title = inWindowTitle != nullptr ? inWindowTitle : "";
+    }
+}
+
+void* XPLMGetWindowRefCon(XPLMWindowID inWindowID)
+{
+    auto window = GetWindow(inWindowID);
+    return window != nullptr ? window->refcon : nullptr;
+}
+
+void XPLMSetWindowRefCon(XPLMWindowID inWindowID, void* inRefcon)
+{
+    auto window = GetWindow(inWindowID);
+    if (window != nullptr)
+    {
+        window->refcon = inRefcon;
+    }
+}
+
+void XPLMTakeKeyboardFocus(XPLMWindowID inWindow)
+{
+    auto window = GetWindow(inWindow);
+    if (window == keyboardFocus)
+        return;
+
+    // The window losing the focus gets a key event with the losing focus flag.
+    auto previous = keyboardFocus;
+    keyboardFocus = window;
+    if (previous != nullptr && previous->handleKeyFunc != nullptr)
+    {
+        SimCallbackScope scope(previous->plugin, "window_key");
+        previous->handleKeyFunc(previous, 0, 0, 0, previous->refcon, 1);
+    }
+}
+
+int XPLMHasKeyboardFocus(XPLMWindowID inWindow)
+{
+    // The null window is X-Plane itself.
+    return inWindow == nullptr ? keyboardFocus == nullptr : keyboardFocus != nullptr && keyboardFocus == inWindow;
+}
+
+void XPLMBringWindowToFront(XPLMWindowID inWindow)
+{
+    auto window = GetWindow(inWindow);
+    if (window == nullptr)
+        return;
+
+    auto found = std::find_if(windows.begin(), windows.end(), [=](auto& w) { return w.get() == window; });
+    auto moved = std::move(*found);
+    windows.erase(found);
+    PlaceInFront(std::move(moved));
+}
+
+int XPLMIsWindowInFront(XPLMWindowID inWindow)
+{
+    auto window = GetWindow(inWindow);
+    if (window == nullptr)
+        return 0;
+
+    auto front = std::find_if(windows.rbegin(), windows.rend(), [=](auto& w) {
+        return w->layer == window->layer && w->visible && !w->removed;
+    });
+    return front != windows.rend() && front->get() == window;
+}
@@ -0,0 +1,111 @@
+#include "dataref_cache.h"
+#include "standard_datarefs.h"
+
+// The initial number of the slots, a power of two, so that the standard datarefs fill at most a quarter of the table.
+static const int INITIAL_SLOTS = 512;
+
+static_assert(STANDARD_DATAREF_COUNT * 4 <= INITIAL_SLOTS, "The cache must start with room for the standard datarefs.");
+
+// The generation 0 marks the names which have not been looked up yet.
+dataref_cache::dataref_cache() : count(0), generation(1), misses_cached(false)
+{
+}
+
+dataref_cache& dataref_cache::instance()
+{
+    static dataref_cache instance;
+    return instance;
+}
+
+void dataref_cache::start()
+{
+    if (!slots.empty())
+        return;
+
+    slots.resize(INITIAL_SLOTS);
+    for (size_t i = 0; i < STANDARD_DATAREF_COUNT; i++)
+    {
+        auto hash = STANDARD_DATAREF_HASHES[i];
+        find_slot(hash) = entry { hash, STANDARD_DATAREF_NAMES[i], nullptr, 0, true };
+        count++;
+    }
+}
+
+void dataref_cache::stop()
+{
+    slots = {};
+    count = 0;
+    generation = 1;
+    misses_cached = false;
+}
+
+void dataref_cache::invalidate(bool from_message)
+{
+    generation++;
+    if (from_message)
+    {
+        misses_cached = true;
+    }
+}
+
+dataref_cache::entry& dataref_cache::find_slot(uint64_t hash)
+{
+    auto mask = slots.size() - 1;
+    for (auto index = (size_t)hash & mask;; index = (index + 1) & mask)
+    {
+        auto& slot = slots[index];
+        if (!slot.used || slot.hash == hash)
+            return slot;
+    }
+}
+
+void dataref_cache::grow()
+{
+    auto old_slots = std::move(slots);
+    slots.clear();
+    slots.resize(old_slots.size() * 2);
+    for (auto& slot : old_slots)
+    {
+        if (slot.used)
+        {
+            find_slot(slot.hash) = std::move(slot);
+        }
+    }
+}
+
+XPLMDataRef dataref_cache::find(uint64_t hash, const char* name)
+{
+    if (slots.empty())
+        return XPLMFindDataRef(name);
+
+    auto slot = &find_slot(hash);
+    if (slot->used)
+    {
+        // The slot belongs to the first name found with the hash, and the other names with the same hash are not cached.
+        if (slot->name != name)
+            return XPLMFindDataRef(name);
+        if (slot->ref != nullptr)
+            return slot->ref;
+        if (misses_cached && slot->missed_generation == generation)
+            return nullptr;
+
+        slot->ref = XPLMFindDataRef(name);
+        slot->missed_generation = slot->ref == nullptr ? generation : 0;
+        return slot->ref;
+    }
+
+    auto ref = XPLMFindDataRef(name);
+    if ((count + 1) * 2 > (int)slots.size())
+    {
+        grow();
+        slot = &find_slot(hash);
+    }
+    count++;
+    *slot = entry { hash, name, ref, ref == nullptr ? generation : 0, true };
+    return ref;
+}
+
+XPLMDataRef find_cached_dataref(uint64_t hash, const char* name)
+{
+    return dataref_cache::instance().find(hash, name);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <XPLMDataAccess.h>
+
+// Sent by X-Plane 12 when plugins or X-Plane have registered new datarefs. It is defined by the XPLM400 SDK,
+// which xphost is not built against.
+#ifndef XPLM_MSG_DATAREFS_ADDED
+#define XPLM_MSG_DATAREFS_ADDED 114
+#endif
+
+// The 64 bit FNV-1a hash of the UTF-8 name of a dataref, which keys the cache.
+// It is evaluated at compile time for the standard datarefs, and XP.SDK.XPLM.DataRefName computes it once per name.
+constexpr uint64_t hash_dataref_name(const char* name)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (; *name != 0; name++)
+    {
+        hash = (hash ^ (uint8_t)*name) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// The same hash is checked by the dataref cache test of the sample plugin, see DataRefCacheTest.cs.
+static_assert(hash_dataref_name("sim/flightmodel/position/latitude") == 0xC11AD164E8132CC3ull, "The hash must not change.");
+
+// Interns the dataref handles found by name, so that a dataref found again is looked up by its precomputed hash,
+// without hashing its name. The name is compared with the one stored in the slot, and a name whose hash collides
+// with another one is looked up by XPLMFindDataRef every time. The standard datarefs are checked to have distinct hashes
+// at compile time.
+// The handles stay valid for the lifetime of X-Plane, even when the dataref is unregistered and registered again,
+// so only the names which are not found may change. They are cached only once X-Plane is known to send
+// XPLM_MSG_DATAREFS_ADDED, which invalidates them, and otherwise looked up again every time.
+class dataref_cache
+{
+private:
+    struct entry
+    {
+        uint64_t hash;
+        std::string name;
+        XPLMDataRef ref;
+        // The generation in which the name was not found.
+        uint32_t missed_generation;
+        bool used;
+    };
+
+    // Open addressing with linear probing, at most half full.
+    std::vector<entry> slots;
+    int count;
+    uint32_t generation;
+    bool misses_cached;
+
+    dataref_cache();
+
+    entry& find_slot(uint64_t hash);
+    void grow();
+
+public:
+    static dataref_cache& instance();
+
+    // Adds the standard datarefs, so that the table does not grow when they are found.
+    void start();
+    // Clears the table. Each managed plugin has its own copy of xphost and so its own table,
+    // which does not survive the plugin being stopped.
+    void stop();
+
+    // Invalidates the names which have not been found, on XPLM_MSG_DATAREFS_ADDED, or when xphost registers a dataref.
+    void invalidate(bool from_message);
+
+    // Returns the dataref, as XPLMFindDataRef, whose name has the hash.
+    XPLMDataRef find(uint64_t hash, const char* name);
+};
+
+XPLMDataRef find_cached_dataref(uint64_t hash, const char* name);
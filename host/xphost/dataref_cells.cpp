@@ -0,0 +1,158 @@
+#include "dataref_cells.h"
+#include "dataref_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+// The accessors of the cells, instantiated per value type.
+
+template <typename T>
+static T get_value(void* refcon)
+{
+    return *(const T*)((dataref_cell*)refcon)->values;
+}
+
+template <typename T>
+static void set_value(void* refcon, T value)
+{
+    auto cell = (dataref_cell*)refcon;
+    *(T*)cell->values = value;
+    cell->writes++;
+}
+
+template <typename T>
+static int get_values(void* refcon, T* out_values, int offset, int max)
+{
+    // Like the X-Plane datarefs, a null buffer asks for the length.
+    auto cell = (dataref_cell*)refcon;
+    if (out_values == nullptr)
+        return cell->length;
+    if (offset < 0 || offset >= cell->length || max <= 0)
+        return 0;
+
+    auto count = std::min(max, cell->length - offset);
+    std::memcpy(out_values, (const T*)cell->values + offset, count * sizeof(T));
+    return count;
+}
+
+template <typename T>
+static void set_values(void* refcon, T* values, int offset, int count)
+{
+    auto cell = (dataref_cell*)refcon;
+    if (values == nullptr || offset < 0 || offset >= cell->length || count <= 0)
+        return;
+
+    std::memcpy((T*)cell->values + offset, values, std::min(count, cell->length - offset) * sizeof(T));
+    cell->writes++;
+}
+
+static int get_bytes(void* refcon, void* out_values, int offset, int max)
+{
+    return get_values(refcon, (uint8_t*)out_values, offset, max);
+}
+
+static void set_bytes(void* refcon, void* values, int offset, int count)
+{
+    set_values(refcon, (uint8_t*)values, offset, count);
+}
+
+dataref_cells& dataref_cells::instance()
+{
+    static dataref_cells instance;
+    return instance;
+}
+
+void dataref_cells::stop()
+{
+    for (auto& cell : cells)
+    {
+        XPLMUnregisterDataAccessor(cell->state.ref);
+    }
+    cells.clear();
+}
+
+static int get_value_size(XPLMDataTypeID type, int capacity)
+{
+    switch (type)
+    {
+    case xplmType_Int:
+    case xplmType_Float:
+        return 4;
+    case xplmType_Double:
+        return 8;
+    case xplmType_IntArray:
+    case xplmType_FloatArray:
+        return capacity * 4;
+    case xplmType_Data:
+        return capacity;
+    default:
+        return -1;
+    }
+}
+
+dataref_cell* dataref_cells::create(const char* name, XPLMDataTypeID type, int capacity, int writable)
+{
+    bool is_array = type == xplmType_IntArray || type == xplmType_FloatArray || type == xplmType_Data;
+    capacity = is_array ? std::max(capacity, 0) : 1;
+    auto size = get_value_size(type, capacity);
+    if (name == nullptr || size < 0)
+        return nullptr;
+
+    auto created = std::make_unique<cell>();
+    created->values.resize(std::max((size + 7) / 8, 1));
+    auto& state = created->state;
+    state.type = type;
+    state.capacity = capacity;
+    state.length = capacity;
+    state.writes = 0;
+    state.values = created->values.data();
+
+    // Only the accessors of the type are registered, and the setters only if the dataref is writable.
+    auto has = [=](XPLMDataTypeID accessor_type) { return type == accessor_type; };
+    auto can_set = [=](XPLMDataTypeID accessor_type) { return writable && type == accessor_type; };
+    state.ref = XPLMRegisterDataAccessor(
+        name,
+        type,
+        writable,
+        has(xplmType_Int) ? get_value<int> : nullptr,
+        can_set(xplmType_Int) ? set_value<int> : nullptr,
+        has(xplmType_Float) ? get_value<float> : nullptr,
+        can_set(xplmType_Float) ? set_value<float> : nullptr,
+        has(xplmType_Double) ? get_value<double> : nullptr,
+        can_set(xplmType_Double) ? set_value<double> : nullptr,
+        has(xplmType_IntArray) ? get_values<int> : nullptr,
+        can_set(xplmType_IntArray) ? set_values<int> : nullptr,
+        has(xplmType_FloatArray) ? get_values<float> : nullptr,
+        can_set(xplmType_FloatArray) ? set_values<float> : nullptr,
+        has(xplmType_Data) ? get_bytes : nullptr,
+        can_set(xplmType_Data) ? set_bytes : nullptr,
+        &state,
+        &state);
+    if (state.ref == nullptr)
+        return nullptr;
+
+    // The managed code may look the dataref up before X-Plane sends XPLM_MSG_DATAREFS_ADDED for it.
+    dataref_cache::instance().invalidate(false);
+    cells.push_back(std::move(created));
+    return &cells.back()->state;
+}
+
+void dataref_cells::destroy(dataref_cell* state)
+{
+    auto found = std::find_if(cells.begin(), cells.end(), [=](auto& c) { return &c->state == state; });
+    if (found == cells.end())
+        return;
+
+    XPLMUnregisterDataAccessor(state->ref);
+    cells.erase(found);
+}
+
+dataref_cell* create_dataref_cell(const char* name, XPLMDataTypeID type, int capacity, int writable)
+{
+    return dataref_cells::instance().create(name, type, capacity, writable);
+}
+
+void destroy_dataref_cell(dataref_cell* cell)
+{
+    dataref_cells::instance().destroy(cell);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <XPLMDataAccess.h>
+
+// The value of a dataref published by the plugin, kept in native memory. The accessors registered by xphost read
+// and write the memory directly, so the reads of the other plugins and of X-Plane never enter the managed code,
+// which updates the value in place.
+// The values hold a single int, float or double, or capacity array elements or bytes, of which the first length are published.
+// It is mirrored by XP.SDK.XPLM.Internal.DataRefCellState.
+struct dataref_cell
+{
+    XPLMDataRef ref;
+    XPLMDataTypeID type;
+    int capacity;
+    int length;
+    // The number of the writes made through the dataref, by the other plugins or X-Plane, which the managed code may poll.
+    int64_t writes;
+    void* values;
+};
+
+class dataref_cells
+{
+private:
+    struct cell
+    {
+        // The state is the first member, so that the cell is found from the pointer given to the managed code.
+        dataref_cell state;
+        // 8 byte elements, so that a double is aligned.
+        std::vector<uint64_t> values;
+    };
+
+    std::vector<std::unique_ptr<cell>> cells;
+
+    dataref_cells() = default;
+
+public:
+    static dataref_cells& instance();
+
+    // Unregisters the cells which the plugin has not destroyed.
+    void stop();
+
+    // Publishes a dataref of the type, which must be exactly one of the XPLMDataTypeID values, with a zero value.
+    // The capacity is the number of the array elements or bytes, and is ignored for the other types.
+    // Returns null if the dataref cannot be registered.
+    dataref_cell* create(const char* name, XPLMDataTypeID type, int capacity, int writable);
+    void destroy(dataref_cell* state);
+};
+
+dataref_cell* create_dataref_cell(const char* name, XPLMDataTypeID type, int capacity, int writable);
+void destroy_dataref_cell(dataref_cell* cell);
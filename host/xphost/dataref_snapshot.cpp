@@ -0,0 +1,331 @@
+#include "dataref_snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+// The values are compared 8 words at a time: with AVX2 if the CPU supports it, with SSE2 on every x64 CPU, and with plain
+// loops elsewhere. The AVX2 code is compiled for that target only, so xphost still runs on the CPUs without it.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XPHOST_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define XPHOST_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define XPHOST_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static int count_trailing_zeros(uint32_t value)
+{
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (int)index;
+}
+#else
+static int count_trailing_zeros(uint32_t value)
+{
+    return __builtin_ctz(value);
+}
+#endif
+
+#if XPHOST_SSE2
+static bool has_avx2()
+{
+    // AVX2 needs the support of the CPU, and of the OS, which saves the YMM registers.
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || (ecx & (1 << 27)) == 0)
+        return false;
+    unsigned int xcr0_low, xcr0_high;
+    __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+    if ((xcr0_low & 6) != 6)
+        return false;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1 << 5)) != 0;
+#endif
+}
+
+// Compares 8 words of the values with the previous ones, which it replaces. Returns a bit per changed word.
+XPHOST_TARGET_AVX2 static uint32_t compare_words_avx2(const uint32_t* values, uint32_t* previous)
+{
+    auto current = _mm256_load_si256((const __m256i*)values);
+    auto old = _mm256_load_si256((const __m256i*)previous);
+    _mm256_store_si256((__m256i*)previous, current);
+    return ~(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(current, old))) & 0xFF;
+}
+
+static uint32_t compare_words_sse2(const uint32_t* values, uint32_t* previous)
+{
+    auto low = _mm_load_si128((const __m128i*)values);
+    auto high = _mm_load_si128((const __m128i*)values + 1);
+    auto equal_low = _mm_cmpeq_epi32(low, _mm_load_si128((const __m128i*)previous));
+    auto equal_high = _mm_cmpeq_epi32(high, _mm_load_si128((const __m128i*)previous + 1));
+    _mm_store_si128((__m128i*)previous, low);
+    _mm_store_si128((__m128i*)previous + 1, high);
+    auto equal = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(equal_low)) | (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(equal_high)) << 4;
+    return ~equal & 0xFF;
+}
+#else
+static uint32_t compare_words_scalar(const uint32_t* values, uint32_t* previous)
+{
+    uint32_t changed = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        changed |= (uint32_t)(values[i] != previous[i]) << i;
+        previous[i] = values[i];
+    }
+    return changed;
+}
+#endif
+
+using compare_words_function = uint32_t (*)(const uint32_t* values, uint32_t* previous);
+
+static compare_words_function select_compare_words()
+{
+#if XPHOST_SSE2
+    return has_avx2() ? compare_words_avx2 : compare_words_sse2;
+#else
+    return compare_words_scalar;
+#endif
+}
+
+static const compare_words_function compare_words = select_compare_words();
+
+dataref_snapshots::dataref_snapshots() : flight_loop(nullptr)
+{
+}
+
+dataref_snapshots& dataref_snapshots::instance()
+{
+    static dataref_snapshots instance;
+    return instance;
+}
+
+void dataref_snapshots::start()
+{
+    if (flight_loop != nullptr)
+        return;
+
+    // The flight loop is only scheduled while there are snapshots to read.
+    XPLMCreateFlightLoop_t parameters
+    {
+        sizeof(XPLMCreateFlightLoop_t),
+        xplm_FlightLoop_Phase_BeforeFlightModel,
+        read_frame,
+        this
+    };
+    flight_loop = XPLMCreateFlightLoop(&parameters);
+}
+
+void dataref_snapshots::stop()
+{
+    if (flight_loop != nullptr)
+    {
+        XPLMDestroyFlightLoop(flight_loop);
+        flight_loop = nullptr;
+    }
+    snapshots.clear();
+}
+
+static int get_value_size(XPLMDataTypeID type, int count)
+{
+    switch (type)
+    {
+    case xplmType_Int:
+    case xplmType_Float:
+        return 4;
+    case xplmType_Double:
+        return 8;
+    case xplmType_FloatArray:
+    case xplmType_IntArray:
+        return count * 4;
+    case xplmType_Data:
+        return count;
+    default:
+        return 0;
+    }
+}
+
+dataref_snapshot* dataref_snapshots::create(const XPLMDataRef* refs, const XPLMDataTypeID* types, const int* counts, int count)
+{
+    if (count < 0 || refs == nullptr || types == nullptr)
+        return nullptr;
+
+    auto created = std::make_unique<snapshot>();
+    created->entries.reserve(count);
+    created->offsets.reserve(count);
+    int size = 0;
+    for (int i = 0; i < count; i++)
+    {
+        auto type = types[i];
+        auto value_count = std::max(counts != nullptr ? counts[i] : 1, 0);
+        auto alignment = type == xplmType_Double ? 8 : 4;
+        size = (size + alignment - 1) & -alignment;
+        created->entries.push_back(entry { refs[i], type, value_count });
+        created->offsets.push_back(size);
+        size += get_value_size(type, value_count);
+    }
+
+    // The whole blocks are zeroed, so the padding compares equal from a read to the next one.
+    auto blocks = (size + sizeof(block) - 1) / sizeof(block);
+    created->values.resize(blocks, block {});
+    created->previous.resize(blocks, block {});
+    created->word_entries.assign(blocks * sizeof(block) / 4, -1);
+    for (int i = 0; i < count; i++)
+    {
+        auto& entry = created->entries[i];
+        auto first_word = created->offsets[i] / 4;
+        auto words = (get_value_size(entry.type, entry.count) + 3) / 4;
+        std::fill_n(created->word_entries.begin() + first_word, words, i);
+    }
+    created->changed_bits.resize((count + 31) / 32);
+    created->changed.resize(count);
+
+    auto& state = created->state;
+    state.count = count;
+    state.size = (int)(blocks * sizeof(block));
+    state.offsets = created->offsets.data();
+    state.values = blocks > 0 ? created->values.front().bytes : nullptr;
+    state.reads = 0;
+    state.changed_bits = created->changed_bits.data();
+    state.changed = created->changed.data();
+    state.changed_count = 0;
+    read(&state);
+
+    if (snapshots.empty() && flight_loop != nullptr)
+    {
+        XPLMScheduleFlightLoop(flight_loop, -1, 1);
+    }
+    snapshots.push_back(std::move(created));
+    return &snapshots.back()->state;
+}
+
+void dataref_snapshots::destroy(dataref_snapshot* state)
+{
+    auto found = std::find_if(snapshots.begin(), snapshots.end(), [=](auto& s) { return &s->state == state; });
+    if (found == snapshots.end())
+        return;
+
+    snapshots.erase(found);
+    if (snapshots.empty() && flight_loop != nullptr)
+    {
+        XPLMScheduleFlightLoop(flight_loop, 0, 1);
+    }
+}
+
+void dataref_snapshots::read(dataref_snapshot* state)
+{
+    auto self = (snapshot*)state;
+    auto values = state->values;
+    auto offsets = state->offsets;
+    auto entries = self->entries.data();
+    for (int i = 0, count = state->count; i < count; i++)
+    {
+        auto& entry = entries[i];
+        auto value = values + offsets[i];
+        switch (entry.type)
+        {
+        case xplmType_Int:
+            *(int*)value = XPLMGetDatai(entry.ref);
+            break;
+        case xplmType_Float:
+            *(float*)value = XPLMGetDataf(entry.ref);
+            break;
+        case xplmType_Double:
+            *(double*)value = XPLMGetDatad(entry.ref);
+            break;
+        case xplmType_FloatArray:
+            XPLMGetDatavf(entry.ref, (float*)value, 0, entry.count);
+            break;
+        case xplmType_IntArray:
+            XPLMGetDatavi(entry.ref, (int*)value, 0, entry.count);
+            break;
+        case xplmType_Data:
+            XPLMGetDatab(entry.ref, value, 0, entry.count);
+            break;
+        }
+    }
+    find_changes(self);
+    state->reads++;
+}
+
+void dataref_snapshots::find_changes(snapshot* self)
+{
+    auto& state = self->state;
+    auto bits = self->changed_bits.data();
+    auto changed = self->changed.data();
+    for (int i = 0; i < state.changed_count; i++)
+    {
+        bits[changed[i] / 32] = 0;
+    }
+
+    int changed_count = 0;
+    if (state.reads == 0)
+    {
+        std::memcpy(self->previous.data(), state.values, state.size);
+        for (int i = 0; i < state.count; i++)
+        {
+            bits[i / 32] |= 1u << (i % 32);
+            changed[changed_count++] = i;
+        }
+        state.changed_count = changed_count;
+        return;
+    }
+
+    // The words are scanned in order, so the datarefs are found in order, and the words of a dataref follow each other.
+    auto values = (const uint32_t*)state.values;
+    auto previous = (uint32_t*)self->previous.data();
+    auto word_entries = self->word_entries.data();
+    for (int word = 0, words = state.size / 4; word < words; word += 8)
+    {
+        auto changed_words = compare_words(values + word, previous + word);
+        while (changed_words != 0)
+        {
+            auto entry = word_entries[word + count_trailing_zeros(changed_words)];
+            changed_words &= changed_words - 1;
+            if (changed_count > 0 && changed[changed_count - 1] == entry)
+                continue;
+
+            bits[entry / 32] |= 1u << (entry % 32);
+            changed[changed_count++] = entry;
+        }
+    }
+    state.changed_count = changed_count;
+}
+
+float dataref_snapshots::read_frame(float /*elapsed_since_last_call*/, float /*elapsed_since_last_flight_loop*/, int /*counter*/, void* refcon)
+{
+    auto self = (dataref_snapshots*)refcon;
+    for (auto& snapshot : self->snapshots)
+    {
+        read(&snapshot->state);
+    }
+    return -1;
+}
+
+dataref_snapshot* create_dataref_snapshot(const XPLMDataRef* refs, const XPLMDataTypeID* types, const int* counts, int count)
+{
+    return dataref_snapshots::instance().create(refs, types, counts, count);
+}
+
+void destroy_dataref_snapshot(dataref_snapshot* snapshot)
+{
+    dataref_snapshots::instance().destroy(snapshot);
+}
+
+void read_dataref_snapshot(dataref_snapshot* snapshot)
+{
+    if (snapshot != nullptr)
+    {
+        dataref_snapshots::read(snapshot);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <XPLMDataAccess.h>
+#include <XPLMProcessing.h>
+
+// The values of a set of datarefs, read into one contiguous buffer at the start of every frame.
+// The values of the dataref i start at values + offsets[i]: a single int, float or double, or count array elements or bytes.
+// Every dataref starts on a 4 byte boundary, and the doubles on an 8 byte boundary. The buffer is 32 byte aligned,
+// and its size is a multiple of 32 bytes, with zero padding.
+// Every read also finds the datarefs whose values differ from the previous read, bit for bit, so a NaN which stays NaN
+// is unchanged. The first read reports all the datarefs as changed.
+// It is mirrored by XP.SDK.XPLM.Internal.DataRefSnapshotState.
+struct dataref_snapshot
+{
+    int count;
+    int size;
+    const int* offsets;
+    uint8_t* values;
+    // The number of times the values have been read.
+    int64_t reads;
+    // The datarefs changed by the last read: a bit per dataref in 32 bit words, and their indices in ascending order.
+    const uint32_t* changed_bits;
+    const int* changed;
+    int changed_count;
+};
+
+// Reads the snapshots in a flight loop created when the plugin starts, so that it runs before the flight loops
+// of the managed plugin, which are created later.
+class dataref_snapshots
+{
+private:
+    struct alignas(32) block
+    {
+        uint8_t bytes[32];
+    };
+
+    struct entry
+    {
+        XPLMDataRef ref;
+        XPLMDataTypeID type;
+        int count;
+    };
+
+    struct snapshot
+    {
+        // The state is the first member, so that the snapshot is found from the pointer given to the managed code.
+        dataref_snapshot state;
+        std::vector<entry> entries;
+        std::vector<int> offsets;
+        std::vector<block> values;
+        // The values of the previous read, and the dataref of each 4 byte word of the values, or -1 for the padding.
+        std::vector<block> previous;
+        std::vector<int> word_entries;
+        std::vector<uint32_t> changed_bits;
+        std::vector<int> changed;
+    };
+
+    std::vector<std::unique_ptr<snapshot>> snapshots;
+    XPLMFlightLoopID flight_loop;
+
+    dataref_snapshots();
+
+    static float read_frame(float elapsed_since_last_call, float elapsed_since_last_flight_loop, int counter, void* refcon);
+    static void find_changes(snapshot* self);
+
+public:
+    static dataref_snapshots& instance();
+
+    void start();
+    void stop();
+
+    // Creates a snapshot of count datarefs. The type of each dataref must be exactly one of the XPLMDataTypeID values;
+    // counts gives the number of the array elements or bytes read from the array and data datarefs, and may be null
+    // if there are none. The values are read right away, and then at the start of every frame until the snapshot is destroyed.
+    dataref_snapshot* create(const XPLMDataRef* refs, const XPLMDataTypeID* types, const int* counts, int count);
+    void destroy(dataref_snapshot* state);
+
+    // Reads the values of the snapshot now, e.g. after the flight model.
+    static void read(dataref_snapshot* state);
+};
+
+dataref_snapshot* create_dataref_snapshot(const XPLMDataRef* refs, const XPLMDataTypeID* types, const int* counts, int count);
+void destroy_dataref_snapshot(dataref_snapshot* snapshot);
+void read_dataref_snapshot(dataref_snapshot* snapshot);
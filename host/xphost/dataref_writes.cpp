@@ -0,0 +1,189 @@
+#include "dataref_writes.h"
+
+#include <algorithm>
+#include <numeric>
+
+// The number of the writes the managed code can queue before it has to flush.
+static const int QUEUE_CAPACITY = 4096;
+
+dataref_writes::dataref_writes() : queue {}, flight_loops {}, in_flush(false)
+{
+}
+
+dataref_writes& dataref_writes::instance()
+{
+    static dataref_writes instance;
+    return instance;
+}
+
+void dataref_writes::start()
+{
+    if (flight_loops[0] != nullptr)
+        return;
+
+    // The flight loops are only scheduled once the queue is used.
+    XPLMFlightLoopPhaseType phases[] = { xplm_FlightLoop_Phase_BeforeFlightModel, xplm_FlightLoop_Phase_AfterFlightModel };
+    for (int i = 0; i < 2; i++)
+    {
+        XPLMCreateFlightLoop_t parameters
+        {
+            sizeof(XPLMCreateFlightLoop_t),
+            phases[i],
+            flush_frame,
+            this
+        };
+        flight_loops[i] = XPLMCreateFlightLoop(&parameters);
+    }
+}
+
+void dataref_writes::stop()
+{
+    // xphost flushes the queue before the managed plugin is stopped. The writes queued while it is stopped are dropped,
+    // since the managed accessors of the datarefs they may target are gone.
+    for (auto& flight_loop : flight_loops)
+    {
+        if (flight_loop != nullptr)
+        {
+            XPLMDestroyFlightLoop(flight_loop);
+            flight_loop = nullptr;
+        }
+    }
+    queue = {};
+    records = {};
+}
+
+dataref_write_queue* dataref_writes::get_queue()
+{
+    if (queue.records == nullptr)
+    {
+        records.resize(QUEUE_CAPACITY);
+        queue.capacity = QUEUE_CAPACITY;
+        queue.records = records.data();
+        for (auto flight_loop : flight_loops)
+        {
+            if (flight_loop != nullptr)
+            {
+                XPLMScheduleFlightLoop(flight_loop, -1, 1);
+            }
+        }
+    }
+    return &queue;
+}
+
+static bool is_array(XPLMDataTypeID type)
+{
+    return type == xplmType_FloatArray || type == xplmType_IntArray;
+}
+
+void dataref_writes::flush()
+{
+    // A setter may flush the writes it queues, which are then left for the flush in progress.
+    auto count = std::min(queue.count, queue.capacity);
+    if (count <= 0 || in_flush)
+        return;
+
+    in_flush = true;
+    flushing.assign(records.begin(), records.begin() + count);
+    queue.count = 0;
+    queue.writes += count;
+
+    // The writes are sorted by the value they write, and by the order they have been queued in for the same value,
+    // so that the last write of each value is the last of its group, and the elements of an array follow each other.
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0);
+    auto& writes = flushing;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        auto& x = writes[a];
+        auto& y = writes[b];
+        if (x.ref != y.ref)
+            return x.ref < y.ref;
+        if (x.type != y.type)
+            return x.type < y.type;
+        if (x.offset != y.offset)
+            return x.offset < y.offset;
+        return a < b;
+    });
+
+    // The last writes are compacted to the start of the order, and then applied in the runs of consecutive array elements.
+    int last_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        auto& write = writes[order[i]];
+        if (i + 1 < count)
+        {
+            auto& next = writes[order[i + 1]];
+            if (next.ref == write.ref && next.type == write.type && next.offset == write.offset)
+                continue;
+        }
+        order[last_count++] = order[i];
+    }
+
+    for (int i = 0; i < last_count;)
+    {
+        auto& first = writes[order[i]];
+        int run = 1;
+        if (is_array(first.type))
+        {
+            while (i + run < last_count)
+            {
+                auto& next = writes[order[i + run]];
+                if (next.ref != first.ref || next.type != first.type || next.offset != first.offset + run)
+                    break;
+                run++;
+            }
+        }
+        apply(order.data() + i, run);
+        queue.calls++;
+        i += run;
+    }
+    in_flush = false;
+}
+
+void dataref_writes::apply(const int* indices, int count)
+{
+    auto& first = flushing[indices[0]];
+    switch (first.type)
+    {
+    case xplmType_Int:
+        XPLMSetDatai(first.ref, first.int_value);
+        break;
+    case xplmType_Float:
+        XPLMSetDataf(first.ref, first.float_value);
+        break;
+    case xplmType_Double:
+        XPLMSetDatad(first.ref, first.double_value);
+        break;
+    case xplmType_FloatArray:
+        float_values.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            float_values[i] = flushing[indices[i]].float_value;
+        }
+        XPLMSetDatavf(first.ref, float_values.data(), first.offset, count);
+        break;
+    case xplmType_IntArray:
+        int_values.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            int_values[i] = flushing[indices[i]].int_value;
+        }
+        XPLMSetDatavi(first.ref, int_values.data(), first.offset, count);
+        break;
+    }
+}
+
+float dataref_writes::flush_frame(float /*elapsed_since_last_call*/, float /*elapsed_since_last_flight_loop*/, int /*counter*/, void* refcon)
+{
+    ((dataref_writes*)refcon)->flush();
+    return -1;
+}
+
+dataref_write_queue* get_dataref_write_queue()
+{
+    return dataref_writes::instance().get_queue();
+}
+
+void flush_dataref_writes()
+{
+    dataref_writes::instance().flush();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <XPLMDataAccess.h>
+#include <XPLMProcessing.h>
+
+// A write of a single value: an int, float or double, or the element at offset of an int or float array.
+// It is mirrored by XP.SDK.XPLM.Internal.DataRefWrite.
+struct dataref_write
+{
+    XPLMDataRef ref;
+    XPLMDataTypeID type;
+    int offset;
+    union
+    {
+        int int_value;
+        float float_value;
+        double double_value;
+    };
+};
+
+// The writes queued by the managed code. The managed code appends the records and increments count,
+// and flushes the queue itself when it is full.
+// It is mirrored by XP.SDK.XPLM.Internal.DataRefWriteQueueState.
+struct dataref_write_queue
+{
+    int capacity;
+    int count;
+    dataref_write* records;
+    // The writes flushed and the XPLMSetData calls made for them since the start, which show the effect of the coalescing.
+    int64_t writes;
+    int64_t calls;
+};
+
+// Applies the queued dataref writes with the XPLMSetData calls in one pass. Only the last write of each value is applied,
+// and the writes to the consecutive elements of an array are applied with one XPLMSetDatavf or XPLMSetDatavi call.
+// The writes to different datarefs may be applied in any order.
+//
+// The queue is flushed at the start of both flight loop phases, by flight loops created when the plugin starts, so that
+// the writes of the managed flight loops before the flight model are applied after it, and those after the flight model
+// are applied before the next one. The managed code may also flush the queue at any time.
+class dataref_writes
+{
+private:
+    dataref_write_queue queue;
+    std::vector<dataref_write> records;
+    // The copy of the records being flushed, since the setters may queue more writes.
+    std::vector<dataref_write> flushing;
+    std::vector<int> order;
+    std::vector<float> float_values;
+    std::vector<int> int_values;
+    XPLMFlightLoopID flight_loops[2];
+    bool in_flush;
+
+    dataref_writes();
+
+    static float flush_frame(float elapsed_since_last_call, float elapsed_since_last_flight_loop, int counter, void* refcon);
+    // Applies the writes of a single value, or of consecutive array elements.
+    void apply(const int* indices, int count);
+
+public:
+    static dataref_writes& instance();
+
+    void start();
+    void stop();
+
+    // Returns the queue, allocating it on the first call.
+    dataref_write_queue* get_queue();
+    void flush();
+};
+
+dataref_write_queue* get_dataref_write_queue();
+void flush_dataref_writes();
@@ -0,0 +1,124 @@
+#include "frame_budget.h"
+
+#include <cstdio>
+
+#include <XPLMUtilities.h>
+
+#include "platform.h"
+
+// An overrun is logged at most once per interval, the others are only counted.
+static const auto REPORT_INTERVAL = std::chrono::seconds(1);
+
+frame_budget::frame_budget() : enabled(false), state {}, flight_loop(nullptr), overruns(0), suppressed_overruns(0)
+{
+}
+
+frame_budget& frame_budget::instance()
+{
+    static frame_budget instance;
+    return instance;
+}
+
+void frame_budget::enable(double budget_ms, bool defer)
+{
+    if (enabled || budget_ms <= 0)
+        return;
+
+    enabled = true;
+    state = {};
+    state.budget_ns = (int64_t)(budget_ms * 1e6);
+    state.slowest_site = -1;
+    state.defer_enabled = defer ? 1 : 0;
+    state.deferred_site = -1;
+
+    // The frame is delimited by a flight loop called before every flight model iteration.
+    XPLMCreateFlightLoop_t parameters
+    {
+        sizeof(XPLMCreateFlightLoop_t),
+        xplm_FlightLoop_Phase_BeforeFlightModel,
+        check_frame,
+        this
+    };
+    flight_loop = XPLMCreateFlightLoop(&parameters);
+    XPLMScheduleFlightLoop(flight_loop, -1, 1);
+}
+
+void frame_budget::disable()
+{
+    if (!enabled)
+        return;
+
+    if (flight_loop != nullptr)
+    {
+        XPLMDestroyFlightLoop(flight_loop);
+        flight_loop = nullptr;
+    }
+
+    char line[128];
+    snprintf(line, sizeof(line), "[xphost] Frame budget exceeded %lld times." ENDL, (long long)overruns);
+    XPLMDebugString(line);
+    enabled = false;
+}
+
+frame_budget_state* frame_budget::get_state()
+{
+    return enabled ? &state : nullptr;
+}
+
+int frame_budget::register_site(const char* kind, const char* name)
+{
+    if (!enabled)
+        return -1;
+
+    // Every registration has its own site, so that only the flight loop which has exceeded the budget is deferred.
+    sites.push_back(site { kind, name });
+    return (int)sites.size() - 1;
+}
+
+void frame_budget::report_overrun()
+{
+    overruns++;
+    auto now = clock::now();
+    if (overruns > 1 && now - last_report < REPORT_INTERVAL)
+    {
+        suppressed_overruns++;
+        return;
+    }
+
+    const char* kind = "unknown";
+    const char* name = "";
+    if (state.slowest_site >= 0 && state.slowest_site < (int)sites.size())
+    {
+        kind = sites[state.slowest_site].kind.c_str();
+        name = sites[state.slowest_site].name.c_str();
+    }
+
+    char line[512];
+    snprintf(line, sizeof(line), "[xphost] Frame budget exceeded: %.2fms > %.2fms, slowest %s %s %.2fms (%lld more since the last report)" ENDL,
+        state.frame_ns / 1e6,
+        state.budget_ns / 1e6,
+        kind,
+        name,
+        state.slowest_ns / 1e6,
+        (long long)suppressed_overruns);
+    XPLMDebugString(line);
+    last_report = now;
+    suppressed_overruns = 0;
+}
+
+float frame_budget::check_frame(float /*elapsed_since_last_call*/, float /*elapsed_since_last_flight_loop*/, int /*counter*/, void* refcon)
+{
+    auto self = (frame_budget*)refcon;
+    auto& state = self->state;
+    state.over_budget = state.frame_ns > state.budget_ns ? 1 : 0;
+    state.deferred_site = state.over_budget ? state.slowest_site : -1;
+    if (state.over_budget)
+    {
+        self->report_overrun();
+    }
+
+    state.frame_ns = 0;
+    state.slowest_ns = 0;
+    state.slowest_site = -1;
+    return -1;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <XPLMProcessing.h>
+
+// The time spent in the managed callbacks during the current frame.
+// It is written directly by the managed code (XP.SDK.XPLM.Internal.FrameBudgetState) after each callback,
+// and checked by xphost once per frame.
+struct frame_budget_state
+{
+    int64_t budget_ns;
+    int64_t frame_ns;
+    int64_t slowest_ns;
+    int32_t slowest_site;
+    // Set by xphost when the previous frame has exceeded the budget.
+    int32_t over_budget;
+    // Whether the deferrable flight loops are skipped for a frame after the budget has been exceeded.
+    int32_t defer_enabled;
+    // Set by xphost to the slowest callback of the previous frame if that frame has exceeded the budget, and to -1 otherwise.
+    // Only that callback is skipped, if it is a deferrable flight loop.
+    int32_t deferred_site;
+};
+
+// Enforces the per-frame budget of the time spent in the managed callbacks of the plugin.
+// The watchdog is enabled by the "frame_budget_ms" setting in xphost.ini.
+class frame_budget
+{
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct site
+    {
+        std::string kind;
+        std::string name;
+    };
+
+    bool enabled;
+    frame_budget_state state;
+    std::vector<site> sites;
+    XPLMFlightLoopID flight_loop;
+    int64_t overruns;
+    int64_t suppressed_overruns;
+    clock::time_point last_report;
+
+    frame_budget();
+
+    static float check_frame(float elapsed_since_last_call, float elapsed_since_last_flight_loop, int counter, void* refcon);
+    void report_overrun();
+
+public:
+    static frame_budget& instance();
+
+    // Starts checking the frame budget, optionally skipping the deferrable flight loops after an overrun.
+    void enable(double budget_ms, bool defer);
+    void disable();
+
+    // Returns the shared state, or nullptr if the watchdog is disabled.
+    frame_budget_state* get_state();
+
+    // Returns the identifier of the callback registration used in the overrun reports and the deferral,
+    // or -1 if the watchdog is disabled.
+    int register_site(const char* kind, const char* name);
+};
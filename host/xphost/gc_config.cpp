@@ -0,0 +1,33 @@
+#include "gc_config.h"
+
+static string_t to_string_t(const std::string& value)
+{
+    // The property values are ASCII, so they are widened character by character on Windows.
+    return string_t(value.begin(), value.end());
+}
+
+static void add_bool_property(runtime_properties& properties, const settings& host_settings, const char* key, const char_t* name)
+{
+    if (host_settings.contains(key))
+    {
+        properties.emplace_back(name, host_settings.get_bool(key) ? STR("true") : STR("false"));
+    }
+}
+
+static void add_number_property(runtime_properties& properties, const settings& host_settings, const char* key, const char_t* name)
+{
+    if (host_settings.contains(key))
+    {
+        properties.emplace_back(name, to_string_t(host_settings.get_string(key)));
+    }
+}
+
+runtime_properties get_gc_properties(const settings& host_settings)
+{
+    runtime_properties properties;
+    add_bool_property(properties, host_settings, "gc_server", STR("System.GC.Server"));
+    add_bool_property(properties, host_settings, "gc_concurrent", STR("System.GC.Concurrent"));
+    add_number_property(properties, host_settings, "gc_heap_hard_limit", STR("System.GC.HeapHardLimit"));
+    add_number_property(properties, host_settings, "gc_conserve_memory", STR("System.GC.ConserveMemory"));
+    return properties;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "platform.h"
+#include "settings.h"
+
+// Runtime properties applied to the host context before the runtime is started.
+using runtime_properties = std::vector<std::pair<string_t, string_t>>;
+
+// Maps the GC settings of xphost.ini to the GC configuration properties of the runtime:
+//   gc_server = 1           System.GC.Server
+//   gc_concurrent = 0       System.GC.Concurrent
+//   gc_heap_hard_limit = N  System.GC.HeapHardLimit, in bytes, decimal or 0x-prefixed hexadecimal
+//   gc_conserve_memory = N  System.GC.ConserveMemory, 0-9, honored by .NET 6 and newer runtimes
+// The properties override the values from xpproxy.runtimeconfig.json.
+runtime_properties get_gc_properties(const settings& host_settings);
@@ -0,0 +1,136 @@
+#include "gc_telemetry.h"
+
+#include <cstdio>
+
+#include <XPLMUtilities.h>
+
+#include "platform.h"
+
+// The counters are written by the managed code with interlocked operations, so they are read the same way.
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static int64_t load_counter(int64_t& counter)
+{
+    return _InterlockedCompareExchange64((volatile long long*)&counter, 0, 0);
+}
+
+static int64_t exchange_counter(int64_t& counter, int64_t value)
+{
+    return _InterlockedExchange64((volatile long long*)&counter, value);
+}
+#else
+static int64_t load_counter(int64_t& counter)
+{
+    return __atomic_load_n(&counter, __ATOMIC_SEQ_CST);
+}
+
+static int64_t exchange_counter(int64_t& counter, int64_t value)
+{
+    return __atomic_exchange_n(&counter, value, __ATOMIC_SEQ_CST);
+}
+#endif
+
+static gc_counters load_counters(gc_counters& counters)
+{
+    gc_counters copy;
+    for (int i = 0; i < GC_GENERATIONS; i++)
+    {
+        copy.collections[i] = load_counter(counters.collections[i]);
+    }
+    copy.pause_count = load_counter(counters.pause_count);
+    copy.pause_total_ns = load_counter(counters.pause_total_ns);
+    copy.pause_max_ns = load_counter(counters.pause_max_ns);
+    return copy;
+}
+
+gc_telemetry::gc_telemetry() : enabled(false), log_pause_ms(0), state {}, frame_start {}, flight_loop(nullptr)
+{
+}
+
+gc_telemetry& gc_telemetry::instance()
+{
+    static gc_telemetry instance;
+    return instance;
+}
+
+void gc_telemetry::enable(double log_pause_ms)
+{
+    if (enabled)
+        return;
+
+    enabled = true;
+    this->log_pause_ms = log_pause_ms;
+    state = {};
+    frame_start = {};
+
+    XPLMCreateFlightLoop_t parameters
+    {
+        sizeof(XPLMCreateFlightLoop_t),
+        xplm_FlightLoop_Phase_BeforeFlightModel,
+        check_frame,
+        this
+    };
+    flight_loop = XPLMCreateFlightLoop(&parameters);
+    XPLMScheduleFlightLoop(flight_loop, -1, 1);
+}
+
+void gc_telemetry::disable()
+{
+    if (!enabled)
+        return;
+
+    if (flight_loop != nullptr)
+    {
+        XPLMDestroyFlightLoop(flight_loop);
+        flight_loop = nullptr;
+    }
+
+    auto total = load_counters(state.total);
+    char line[256];
+    snprintf(line, sizeof(line), "[xphost] GC: gen0=%lld gen1=%lld gen2=%lld pauses=%lld total=%.2fms max=%.2fms" ENDL,
+        (long long)total.collections[0],
+        (long long)total.collections[1],
+        (long long)total.collections[2],
+        (long long)total.pause_count,
+        total.pause_total_ns / 1e6,
+        total.pause_max_ns / 1e6);
+    XPLMDebugString(line);
+    enabled = false;
+}
+
+gc_telemetry_state* gc_telemetry::get_state()
+{
+    return enabled ? &state : nullptr;
+}
+
+float gc_telemetry::check_frame(float /*elapsed_since_last_call*/, float /*elapsed_since_last_flight_loop*/, int counter, void* refcon)
+{
+    auto self = (gc_telemetry*)refcon;
+    // The total counters are updated concurrently, so they are copied once and all the deltas are taken from the copy.
+    auto total = load_counters(self->state.total);
+    auto& frame = self->state.last_frame;
+    for (int i = 0; i < GC_GENERATIONS; i++)
+    {
+        frame.collections[i] = total.collections[i] - self->frame_start.collections[i];
+    }
+    frame.pause_count = total.pause_count - self->frame_start.pause_count;
+    frame.pause_total_ns = total.pause_total_ns - self->frame_start.pause_total_ns;
+    frame.pause_max_ns = exchange_counter(self->state.frame_pause_max_ns, 0);
+    self->frame_start = total;
+
+    if (frame.pause_count > 0 && (frame.collections[2] > 0 || frame.pause_total_ns >= self->log_pause_ms * 1e6))
+    {
+        char line[256];
+        snprintf(line, sizeof(line), "[xphost] GC in frame %d: gen0=%lld gen1=%lld gen2=%lld pauses=%lld pause=%.2fms max=%.2fms" ENDL,
+            counter,
+            (long long)frame.collections[0],
+            (long long)frame.collections[1],
+            (long long)frame.collections[2],
+            (long long)frame.pause_count,
+            frame.pause_total_ns / 1e6,
+            frame.pause_max_ns / 1e6);
+        XPLMDebugString(line);
+    }
+    return -1;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include <XPLMProcessing.h>
+
+#define GC_GENERATIONS 3
+
+// Garbage collection counters. The cumulative counters are written by the managed code
+// (XP.SDK.GCTelemetry) from the runtime event dispatch thread, and xphost derives the per-frame counters.
+struct gc_counters
+{
+    int64_t collections[GC_GENERATIONS];
+    int64_t pause_count;
+    int64_t pause_total_ns;
+    int64_t pause_max_ns;
+};
+
+struct gc_telemetry_state
+{
+    // The counters since the telemetry has been enabled.
+    gc_counters total;
+    // The counters of the last completed frame.
+    gc_counters last_frame;
+    // The longest pause since the start of the current frame, reset by xphost at the end of the frame.
+    int64_t frame_pause_max_ns;
+};
+
+// Reports the garbage collections and the pauses they cause, per frame.
+// The telemetry is enabled by the "gc_telemetry" setting in xphost.ini.
+// The runtime delivers the GC events asynchronously, so a collection may be attributed to the next frame.
+class gc_telemetry
+{
+private:
+    bool enabled;
+    double log_pause_ms;
+    gc_telemetry_state state;
+    gc_counters frame_start;
+    XPLMFlightLoopID flight_loop;
+
+    gc_telemetry();
+
+    static float check_frame(float elapsed_since_last_call, float elapsed_since_last_flight_loop, int counter, void* refcon);
+
+public:
+    static gc_telemetry& instance();
+
+    // Starts collecting the telemetry. A frame is logged when it contains a gen2 collection
+    // or when its GC pauses take at least log_pause_ms.
+    void enable(double log_pause_ms);
+    void disable();
+
+    // Returns the shared state, or nullptr if the telemetry is disabled.
+    gc_telemetry_state* get_state();
+};
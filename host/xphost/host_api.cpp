@@ -0,0 +1,70 @@
+#include "host_api.h"
+#include "startup_trace.h"
+#include "profiler.h"
+#include "frame_budget.h"
+#include "gc_telemetry.h"
+#include "nav_batch.h"
+#include "probe_batch.h"
+#include "instance_batch.h"
+#include "dataref_snapshot.h"
+#include "dataref_writes.h"
+#include "dataref_cells.h"
+#include "dataref_cache.h"
+
+static void begin_phase(const char* name)
+{
+    startup_trace::instance().begin(name);
+}
+
+static void end_phase(void)
+{
+    startup_trace::instance().end();
+}
+
+static profile_slot* register_profile_slot(const char* kind, const char* name)
+{
+    return profiler::instance().register_slot(kind, name);
+}
+
+static frame_budget_state* get_frame_budget(void)
+{
+    return frame_budget::instance().get_state();
+}
+
+static int register_budget_site(const char* kind, const char* name)
+{
+    return frame_budget::instance().register_site(kind, name);
+}
+
+static gc_telemetry_state* get_gc_telemetry(void)
+{
+    return gc_telemetry::instance().get_state();
+}
+
+static const host_api api
+{
+    sizeof(host_api),
+    begin_phase,
+    end_phase,
+    register_profile_slot,
+    get_frame_budget,
+    register_budget_site,
+    get_gc_telemetry,
+    read_nav_aid_range,
+    read_nav_aid_list,
+    probe_terrain_batch,
+    set_instance_positions,
+    create_dataref_snapshot,
+    destroy_dataref_snapshot,
+    read_dataref_snapshot,
+    get_dataref_write_queue,
+    flush_dataref_writes,
+    create_dataref_cell,
+    destroy_dataref_cell,
+    find_cached_dataref
+};
+
+const host_api* get_host_api()
+{
+    return &api;
+}
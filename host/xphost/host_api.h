@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+#include <XPLMDataAccess.h>
+#include <XPLMInstance.h>
+#include <XPLMScenery.h>
+
+struct profile_slot;
+struct frame_budget_state;
+struct gc_telemetry_state;
+struct nav_aid_columns;
+struct dataref_snapshot;
+struct dataref_write_queue;
+struct dataref_cell;
+
+// The table of native services that xphost provides to the managed code.
+// It is passed to XP.Proxy in start_parameters and mirrored by XP.SDK.XPLM.Internal.HostAPI.
+// New functions must be appended to the end of the table.
+struct host_api
+{
+    int size;
+
+    // Startup tracing, see startup_trace.h.
+    void (*begin_phase)(const char* name);
+    void (*end_phase)(void);
+
+    // Callback profiling, see profiler.h.
+    profile_slot* (*register_profile_slot)(const char* kind, const char* name);
+
+    // Frame budget watchdog, see frame_budget.h.
+    frame_budget_state* (*get_frame_budget)(void);
+    int (*register_budget_site)(const char* kind, const char* name);
+
+    // GC telemetry, see gc_telemetry.h.
+    gc_telemetry_state* (*get_gc_telemetry)(void);
+
+    // Batch navaid queries, see nav_batch.h.
+    int (*read_nav_aid_range)(int first, const nav_aid_columns* columns);
+    int (*read_nav_aid_list)(const int* refs, int count, const nav_aid_columns* columns);
+
+    // Batch terrain probes, see probe_batch.h.
+    int (*probe_terrain_batch)(XPLMProbeRef probe, const float* points, int count, XPLMProbeInfo_t* infos, XPLMProbeResult* results);
+
+    // Batch instance updates, see instance_batch.h.
+    void (*set_instance_positions)(const XPLMInstanceRef* instances, int count, const XPLMDrawInfo_t* positions, const float* data, const int* data_offsets);
+
+    // Per-frame dataref snapshots, see dataref_snapshot.h.
+    dataref_snapshot* (*create_dataref_snapshot)(const XPLMDataRef* refs, const XPLMDataTypeID* types, const int* counts, int count);
+    void (*destroy_dataref_snapshot)(dataref_snapshot* snapshot);
+    void (*read_dataref_snapshot)(dataref_snapshot* snapshot);
+
+    // Batch dataref writes, see dataref_writes.h.
+    dataref_write_queue* (*get_dataref_write_queue)(void);
+    void (*flush_dataref_writes)(void);
+
+    // Native dataref storage, see dataref_cells.h.
+    dataref_cell* (*create_dataref_cell)(const char* name, XPLMDataTypeID type, int capacity, int writable);
+    void (*destroy_dataref_cell)(dataref_cell* cell);
+
+    // Dataref handle cache, see dataref_cache.h.
+    XPLMDataRef (*find_cached_dataref)(uint64_t hash, const char* name);
+};
+
+const host_api* get_host_api();
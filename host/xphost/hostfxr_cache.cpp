@@ -0,0 +1,72 @@
+#include "hostfxr_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+static const auto CACHE_VERSION = 1;
+
+static fs::path get_cache_path(const fs::path& plugin_path)
+{
+    return plugin_path / STR("xphost.cache");
+}
+
+static uint64_t hash_file(const fs::path& path)
+{
+    // FNV-1a, 64 bit.
+    uint64_t hash = 14695981039346656037ull;
+    std::ifstream stream(path, std::ios::binary);
+    for (auto it = std::istreambuf_iterator<char>(stream); it != std::istreambuf_iterator<char>(); ++it)
+    {
+        hash ^= (unsigned char)*it;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static long long get_mtime(const fs::path& path)
+{
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    return ec ? 0 : (long long)time.time_since_epoch().count();
+}
+
+static fs::path get_runtime_folder(const fs::path& plugin_path, const fs::path& hostfxr_path)
+{
+    // A new runtime installation adds a folder to host/fxr, which updates its mtime.
+    auto runtime_path = plugin_path / STR("runtime");
+    return fs::exists(runtime_path) ? runtime_path : hostfxr_path.parent_path().parent_path();
+}
+
+static std::string get_cache_key(const fs::path& plugin_path, const fs::path& hostfxr_path)
+{
+    auto config_hash = hash_file(plugin_path / STR("xpproxy.runtimeconfig.json"));
+    auto runtime_mtime = get_mtime(get_runtime_folder(plugin_path, hostfxr_path));
+
+    char key[64];
+    snprintf(key, sizeof(key), "%d:%016llx:%lld", CACHE_VERSION, (unsigned long long)config_hash, runtime_mtime);
+    return key;
+}
+
+std::optional<fs::path> read_hostfxr_cache(const fs::path& plugin_path)
+{
+    std::ifstream stream(get_cache_path(plugin_path));
+    std::string key, hostfxr_path_utf8;
+    if (!std::getline(stream, key) || !std::getline(stream, hostfxr_path_utf8))
+        return std::nullopt;
+
+    auto hostfxr_path = fs::u8path(hostfxr_path_utf8);
+    if (!fs::exists(hostfxr_path) || key != get_cache_key(plugin_path, hostfxr_path))
+        return std::nullopt;
+
+    return hostfxr_path;
+}
+
+void write_hostfxr_cache(const fs::path& plugin_path, const fs::path& hostfxr_path)
+{
+    // The plugin folder may be read-only; the cache is optional, so errors are ignored.
+    std::ofstream stream(get_cache_path(plugin_path), std::ios::trunc);
+    stream << get_cache_key(plugin_path, hostfxr_path) << '\n' << hostfxr_path.u8string() << '\n';
+}
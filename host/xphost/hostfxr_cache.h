@@ -0,0 +1,13 @@
+#pragma once
+
+#include <optional>
+
+#include "platform.h"
+
+// Persists the resolved hostfxr path next to the plugin, so that the warm start
+// does not need to probe the .NET installation with get_hostfxr_path.
+// The cache entry is valid while both the runtime config and the hostfxr folder
+// (or the private runtime folder of the plugin) stay unchanged.
+std::optional<fs::path> read_hostfxr_cache(const fs::path& plugin_path);
+
+void write_hostfxr_cache(const fs::path& plugin_path, const fs::path& hostfxr_path);
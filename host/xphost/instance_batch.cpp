@@ -0,0 +1,12 @@
+#include "instance_batch.h"
+
+void set_instance_positions(const XPLMInstanceRef* instances, int count, const XPLMDrawInfo_t* positions, const float* data, const int* data_offsets)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (instances[i] != nullptr)
+        {
+            XPLMInstanceSetPosition(instances[i], positions + i, data + data_offsets[i]);
+        }
+    }
+}
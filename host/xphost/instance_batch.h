@@ -0,0 +1,7 @@
+#pragma once
+
+#include <XPLMInstance.h>
+
+// Sets the positions and the dataref values of count instances, with one XPLMInstanceSetPosition call per instance
+// but a single transition from the managed code. The dataref values of instance i start at data + data_offsets[i].
+void set_instance_positions(const XPLMInstanceRef* instances, int count, const XPLMDrawInfo_t* positions, const float* data, const int* data_offsets);
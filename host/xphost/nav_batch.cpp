@@ -0,0 +1,40 @@
+#include "nav_batch.h"
+
+static void read_nav_aid(XPLMNavRef ref, int index, const nav_aid_columns* columns)
+{
+    if (columns->refs != nullptr)
+        columns->refs[index] = ref;
+
+    XPLMGetNavAidInfo(ref,
+        columns->types != nullptr ? columns->types + index : nullptr,
+        columns->latitudes != nullptr ? columns->latitudes + index : nullptr,
+        columns->longitudes != nullptr ? columns->longitudes + index : nullptr,
+        columns->heights != nullptr ? columns->heights + index : nullptr,
+        columns->frequencies != nullptr ? columns->frequencies + index : nullptr,
+        columns->headings != nullptr ? columns->headings + index : nullptr,
+        columns->ids != nullptr ? columns->ids + index * NAV_AID_ID_SIZE : nullptr,
+        columns->names != nullptr ? columns->names + index * NAV_AID_NAME_SIZE : nullptr,
+        columns->regions != nullptr ? columns->regions + index : nullptr);
+}
+
+int read_nav_aid_range(XPLMNavRef first, const nav_aid_columns* columns)
+{
+    int count = 0;
+    for (auto ref = first; ref != XPLM_NAV_NOT_FOUND && count < columns->capacity; ref = XPLMGetNextNavAid(ref))
+    {
+        read_nav_aid(ref, count++, columns);
+    }
+    return count;
+}
+
+int read_nav_aid_list(const XPLMNavRef* refs, int count, const nav_aid_columns* columns)
+{
+    if (count > columns->capacity)
+        count = columns->capacity;
+
+    for (int i = 0; i < count; i++)
+    {
+        read_nav_aid(refs[i], i, columns);
+    }
+    return count;
+}
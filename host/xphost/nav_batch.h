@@ -0,0 +1,33 @@
+#pragma once
+
+#include <XPLMNavigation.h>
+
+// The sizes of the ID and name buffers recommended by the SDK for XPLMGetNavAidInfo.
+#define NAV_AID_ID_SIZE 32
+#define NAV_AID_NAME_SIZE 256
+
+// The struct-of-arrays buffer filled by the batch navaid queries.
+// Every non-null column has capacity entries; the ids and names columns have NAV_AID_ID_SIZE and NAV_AID_NAME_SIZE
+// bytes per entry. The null columns are not read, like the null arguments of XPLMGetNavAidInfo.
+// It is mirrored by XP.SDK.XPLM.Internal.NavAidColumns.
+struct nav_aid_columns
+{
+    int capacity;
+    XPLMNavRef* refs;
+    XPLMNavType* types;
+    float* latitudes;
+    float* longitudes;
+    float* heights;
+    int* frequencies;
+    float* headings;
+    char* ids;
+    char* names;
+    char* regions;
+};
+
+// Reads the navaids starting at first, in the order of XPLMGetNextNavAid, until the columns are full or the database ends.
+// Returns the number of the navaids read.
+int read_nav_aid_range(XPLMNavRef first, const nav_aid_columns* columns);
+
+// Reads the given navaids, at most as many as the columns can hold. Returns the number of the navaids read.
+int read_nav_aid_list(const XPLMNavRef* refs, int count, const nav_aid_columns* columns);
@@ -10,6 +10,7 @@
 	#define STRING(s) std::wstring(STR(s))
 	#define DIR_SEPARATOR L'\\'
 	#define ENDL "\r\n"
+	#define LIBRARY_EXTENSION STR(".dll")
 #else
 	#include <dlfcn.h>
 	#include <limits.h>
@@ -20,6 +21,11 @@
 	#define DIR_SEPARATOR '/'
 	#define MAX_PATH PATH_MAX
 	#define ENDL "\n"
+	#if APL
+		#define LIBRARY_EXTENSION STR(".dylib")
+	#else
+		#define LIBRARY_EXTENSION STR(".so")
+	#endif
 #endif
 
 #include <string>
@@ -45,6 +51,15 @@ const fs::path get_startup_path();
 tl::expected<void*, std::string> load_library(const string_t& path);
 tl::expected<void*, std::string> get_export(void* handle, const std::string& name);
 
+unsigned long get_process_id();
+std::string get_environment_variable(const char* name);
+void set_environment_variable(const char* name, const std::string& value);
+
+// Locks the mutex of the process with the name, which is shared by all the copies of xphost in the process.
+// The mutex is unlocked with unlock_process_mutex; remove_name frees the name once no copy of xphost needs the mutex anymore.
+tl::expected<void*, std::string> lock_process_mutex(const std::string& name);
+void unlock_process_mutex(void* mutex, const std::string& name, bool remove_name);
+
 template <typename TFunc>
 tl::expected<TFunc, std::string> get_export(void* handle, const std::string& name)
 {
@@ -2,6 +2,12 @@
 #include "XPLMUtilities.h"
 #include "XPLMPlugin.h"
 
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <unistd.h>
+
 template <typename T>
 std::string format_error(const char* format, T param)
 {
@@ -38,7 +44,7 @@ tl::expected<void*, std::string> load_library(const string_t& path)
     void* h = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
     if (h == nullptr) 
     {
-        tl::make_unexpected(format_error("Failed to load library '%s'.", path.c_str()));
+        return tl::make_unexpected(format_error("Failed to load library '%s'.", path.c_str()));
     }
     return h;
 }
@@ -48,7 +54,54 @@ tl::expected<void*, std::string> get_export(void* h, const std::string& name)
     void* f = dlsym(h, name.c_str());
     if (f == nullptr)
     {
-        tl::make_unexpected(format_error("Failed to load library '%s'.", name.c_str()));
+        return tl::make_unexpected(format_error("Failed to find export '%s'.", name.c_str()));
     }
     return f;
 }
+
+unsigned long get_process_id()
+{
+    return (unsigned long)getpid();
+}
+
+std::string get_environment_variable(const char* name)
+{
+    auto value = getenv(name);
+    return value != nullptr ? std::string(value) : std::string();
+}
+
+void set_environment_variable(const char* name, const std::string& value)
+{
+    setenv(name, value.c_str(), 1);
+}
+
+tl::expected<void*, std::string> lock_process_mutex(const std::string& name)
+{
+    // A named semaphore, because the copies of xphost do not share any symbol.
+    auto semaphore = sem_open(("/" + name).c_str(), O_CREAT, 0600, 1);
+    if (semaphore == SEM_FAILED)
+        return tl::make_unexpected(format_error("sem_open failed, errno = %d", errno));
+
+    while (sem_wait(semaphore) != 0)
+    {
+        if (errno != EINTR)
+        {
+            auto error = errno;
+            sem_close(semaphore);
+            return tl::make_unexpected(format_error("sem_wait failed, errno = %d", error));
+        }
+    }
+    return semaphore;
+}
+
+void unlock_process_mutex(void* mutex, const std::string& name, bool remove_name)
+{
+    // The named semaphores outlive the process, unless their name is removed. The waiting threads still get
+    // the semaphore when it is removed, and the later ones create a new one.
+    if (remove_name)
+    {
+        sem_unlink(("/" + name).c_str());
+    }
+    sem_post((sem_t*)mutex);
+    sem_close((sem_t*)mutex);
+}
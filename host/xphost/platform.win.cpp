@@ -52,3 +52,52 @@ tl::expected<void*, std::string> get_export(void* h, const std::string& name)
     }
     return f;
 }
+
+unsigned long get_process_id()
+{
+    return GetCurrentProcessId();
+}
+
+std::string get_environment_variable(const char* name)
+{
+    std::string value(256, '\0');
+    auto length = GetEnvironmentVariableA(name, &value[0], (DWORD)value.size());
+    if (length >= value.size())
+    {
+        // The buffer is too small, and the length includes the terminating null.
+        value.resize(length);
+        length = GetEnvironmentVariableA(name, &value[0], length);
+        if (length >= value.size())
+            return std::string();
+    }
+    value.resize(length);
+    return value;
+}
+
+void set_environment_variable(const char* name, const std::string& value)
+{
+    SetEnvironmentVariableA(name, value.c_str());
+}
+
+tl::expected<void*, std::string> lock_process_mutex(const std::string& name)
+{
+    auto mutex = CreateMutexA(nullptr, FALSE, ("Local\\" + name).c_str());
+    if (mutex == nullptr)
+        return tl::make_unexpected(format_error("CreateMutex failed, error = %d", GetLastError()));
+
+    // An abandoned mutex is still acquired.
+    if (WaitForSingleObject(mutex, INFINITE) == WAIT_FAILED)
+    {
+        auto error = GetLastError();
+        CloseHandle(mutex);
+        return tl::make_unexpected(format_error("WaitForSingleObject failed, error = %d", error));
+    }
+    return mutex;
+}
+
+void unlock_process_mutex(void* mutex, const std::string& /*name*/, bool /*remove_name*/)
+{
+    // The mutex is destroyed with its last handle, so its name never needs to be removed.
+    ReleaseMutex((HANDLE)mutex);
+    CloseHandle((HANDLE)mutex);
+}
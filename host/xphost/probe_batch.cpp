@@ -0,0 +1,14 @@
+#include "probe_batch.h"
+
+int probe_terrain_batch(XPLMProbeRef probe, const float* points, int count, XPLMProbeInfo_t* infos, XPLMProbeResult* results)
+{
+    int hits = 0;
+    for (int i = 0; i < count; i++)
+    {
+        auto point = points + i * 3;
+        results[i] = XPLMProbeTerrainXYZ(probe, point[0], point[1], point[2], infos + i);
+        if (results[i] == xplm_ProbeHitTerrain)
+            hits++;
+    }
+    return hits;
+}
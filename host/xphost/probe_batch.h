@@ -0,0 +1,8 @@
+#pragma once
+
+#include <XPLMScenery.h>
+
+// Probes the terrain under count points, given as x, y, z triples in the local coordinates, with one
+// XPLMProbeTerrainXYZ call per point but a single transition from the managed code. The structSize of every
+// info must be set, and results receives the result of every probe. Returns the number of the points which hit the terrain.
+int probe_terrain_batch(XPLMProbeRef probe, const float* points, int count, XPLMProbeInfo_t* infos, XPLMProbeResult* results);
@@ -0,0 +1,134 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <XPLMUtilities.h>
+
+#include "platform.h"
+
+profiler::profiler() : enabled(false), report_dataref(nullptr)
+{
+}
+
+profiler& profiler::instance()
+{
+    static profiler instance;
+    return instance;
+}
+
+void profiler::enable(const std::string& dataref_name)
+{
+    if (enabled)
+        return;
+
+    enabled = true;
+    report_dataref = XPLMRegisterDataAccessor(dataref_name.c_str(), xplmType_Data, 0,
+        nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        nullptr, nullptr, nullptr, nullptr,
+        read_report, nullptr,
+        this, nullptr);
+}
+
+void profiler::disable()
+{
+    if (report_dataref != nullptr)
+    {
+        XPLMUnregisterDataAccessor(report_dataref);
+        report_dataref = nullptr;
+    }
+    enabled = false;
+}
+
+profile_slot* profiler::register_slot(const char* kind, const char* name)
+{
+    if (!enabled)
+        return nullptr;
+
+    int number = 1;
+    for (auto& e : entries)
+    {
+        if (e.kind == kind && e.name == name)
+            number++;
+    }
+
+    entries.push_back(entry { kind, name, number, std::make_unique<profile_slot>() });
+    return entries.back().slot.get();
+}
+
+// Returns the upper bound of the log2 bucket containing the given percentile, in microseconds,
+// so the report labels it as a bucket bound rather than as the percentile itself.
+static double get_percentile_us(const profile_slot& slot, double percentile)
+{
+    auto threshold = (int64_t)(slot.count * percentile + 0.5);
+    int64_t cumulative = 0;
+    for (int i = 0; i < PROFILE_HISTOGRAM_BUCKETS; i++)
+    {
+        cumulative += slot.histogram[i];
+        if (cumulative >= threshold)
+            return std::min((double)(2ll << i), (double)slot.max_ns) / 1000.0;
+    }
+    return slot.max_ns / 1000.0;
+}
+
+std::string profiler::report() const
+{
+    std::string result;
+    char line[512];
+    for (auto& e : entries)
+    {
+        auto& slot = *e.slot;
+        if (slot.count == 0)
+            continue;
+
+        // The first registration of a name is reported without its number.
+        char number[16] = {};
+        if (e.number > 1)
+        {
+            snprintf(number, sizeof(number), "#%d", e.number);
+        }
+        snprintf(line, sizeof(line), "%s %s%s count=%lld total=%.3fms avg=%.2fus p50_bucket<=%.2fus p99_bucket<=%.2fus max=%.2fus" ENDL,
+            e.kind.c_str(),
+            e.name.c_str(),
+            number,
+            (long long)slot.count,
+            slot.total_ns / 1e6,
+            slot.total_ns / 1e3 / slot.count,
+            get_percentile_us(slot, 0.5),
+            get_percentile_us(slot, 0.99),
+            slot.max_ns / 1e3);
+        result += line;
+    }
+    return result;
+}
+
+void profiler::dump() const
+{
+    if (!enabled)
+        return;
+
+    XPLMDebugString("[xphost] Callback profile:" ENDL);
+    XPLMDebugString(report().c_str());
+}
+
+int profiler::read_report(void* refcon, void* out_value, int offset, int max_length)
+{
+    auto self = (profiler*)refcon;
+    // The report is rebuilt when the reader starts from the beginning, so that a chunked read is consistent.
+    if (offset == 0 || self->report_cache.empty())
+    {
+        self->report_cache = self->report();
+    }
+
+    auto size = (int)self->report_cache.size();
+    if (out_value == nullptr)
+        return size;
+
+    if (offset >= size || max_length <= 0)
+        return 0;
+
+    auto count = std::min(max_length, size - offset);
+    memcpy(out_value, self->report_cache.data() + offset, count);
+    return count;
+}
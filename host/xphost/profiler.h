@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <XPLMDataAccess.h>
+
+#define PROFILE_HISTOGRAM_BUCKETS 32
+
+// Timing counters of a single callback registration.
+// The slot is written directly by the managed code (XP.SDK.XPLM.Internal.ProfileSlot) after each callback,
+// so the profiling adds no extra native/managed transitions.
+// Bucket i of the histogram counts the callbacks which took [2^i, 2^(i+1)) nanoseconds.
+struct profile_slot
+{
+    int64_t count;
+    int64_t total_ns;
+    int64_t max_ns;
+    int64_t histogram[PROFILE_HISTOGRAM_BUCKETS];
+};
+
+// Collects the time spent in the managed callbacks per callback kind and registration.
+// The profiling is enabled by the "profile" setting in xphost.ini.
+class profiler
+{
+private:
+    struct entry
+    {
+        std::string kind;
+        std::string name;
+        // The number of the registration among those with the same kind and name, from 1.
+        int number;
+        std::unique_ptr<profile_slot> slot;
+    };
+
+    bool enabled;
+    std::vector<entry> entries;
+    XPLMDataRef report_dataref;
+    std::string report_cache;
+
+    profiler();
+
+    static int read_report(void* refcon, void* out_value, int offset, int max_length);
+
+public:
+    static profiler& instance();
+
+    bool is_enabled() const
+    {
+        return enabled;
+    }
+
+    // Enables the profiling and publishes the report as a byte array dataref with the given name.
+    void enable(const std::string& dataref_name);
+    void disable();
+
+    // Returns a new slot for the callback registration, or nullptr if the profiling is disabled.
+    // Registrations with the same kind and name, e.g. two flight loops of the same class, have their own slots,
+    // which the report tells apart by their numbers.
+    profile_slot* register_slot(const char* kind, const char* name);
+
+    std::string report() const;
+    void dump() const;
+};
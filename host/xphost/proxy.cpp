@@ -1,11 +1,49 @@
 
 #include "proxy.h"
+#include "hostfxr_cache.h"
+#include "startup_trace.h"
+
+#include <cstdio>
+#include <cstdint>
+
+// Every copy of xphost.xpl is a separate module with its own globals, so the runtime
+// initialized by the first managed plugin is published through the process environment.
+// The value is "<pid>:<address of load_assembly_and_get_function_pointer>"; the pid
+// guards against the variable being inherited by child processes.
+static const char* const SHARED_RUNTIME_VARIABLE = "XPHOST_SHARED_RUNTIME";
+
+// The copies of xphost may start on worker threads at the same time (see the async_start setting), so the lookup
+// of the shared runtime, its initialization and its publication are serialized by a mutex of the process.
+static std::string get_shared_runtime_mutex_name()
+{
+    return "xphost-runtime-" + std::to_string(get_process_id());
+}
+
+load_assembly_and_get_function_pointer_fn proxy::find_shared_runtime()
+{
+    auto value = get_environment_variable(SHARED_RUNTIME_VARIABLE);
+    if (value.empty())
+        return nullptr;
+
+    unsigned long pid = 0;
+    unsigned long long address = 0;
+    if (sscanf(value.c_str(), "%lu:%llx", &pid, &address) != 2 || pid != get_process_id())
+        return nullptr;
+
+    return (load_assembly_and_get_function_pointer_fn)(uintptr_t)address;
+}
 
-tl::expected<proxy, std::string> proxy::create(fs::path plugin_path) {
+void proxy::publish_shared_runtime(load_assembly_and_get_function_pointer_fn get_delegate)
+{
+    char value[64];
+    snprintf(value, sizeof(value), "%lu:%llx", get_process_id(), (unsigned long long)(uintptr_t)get_delegate);
+    set_environment_variable(SHARED_RUNTIME_VARIABLE, value);
+}
+
+tl::expected<load_assembly_and_get_function_pointer_fn, std::string> proxy::load_runtime(const fs::path& plugin_path, const runtime_properties& properties)
+{
     auto runtime_path = plugin_path / STR("runtime");
     
-    char_t buffer[MAX_PATH];
-    size_t buffer_size = sizeof(buffer) / sizeof(char_t);
     get_hostfxr_parameters hostfxr_parameters
     {
         sizeof(get_hostfxr_parameters),
@@ -13,11 +51,24 @@ tl::expected<proxy, std::string> proxy::create(fs::path plugin_path) {
         fs::exists(runtime_path) ? runtime_path.c_str() : nullptr
     };
 
-    int rc = get_hostfxr_path(buffer, &buffer_size, &hostfxr_parameters);
-    if (rc != 0)
-        return tl::make_unexpected("Failed to find hostfxr library.");
+    auto hostfxr_path = read_hostfxr_cache(plugin_path);
+    if (!hostfxr_path)
+    {
+        trace_phase phase("get_hostfxr_path");
+        char_t buffer[MAX_PATH];
+        size_t buffer_size = sizeof(buffer) / sizeof(char_t);
+        int rc = get_hostfxr_path(buffer, &buffer_size, &hostfxr_parameters);
+        if (rc != 0)
+            return tl::make_unexpected("Failed to find hostfxr library.");
+
+        hostfxr_path = fs::path(buffer);
+        write_hostfxr_cache(plugin_path, *hostfxr_path);
+    }
 
-    auto lib = load_library(buffer);
+    auto lib = [&] {
+        trace_phase phase("load_hostfxr");
+        return load_library(hostfxr_path->native());
+    }();
     if (!lib)
         return tl::make_unexpected(lib.error());
 
@@ -33,6 +84,10 @@ tl::expected<proxy, std::string> proxy::create(fs::path plugin_path) {
     if (!close)
         return tl::make_unexpected(close.error());
 
+    auto set_runtime_property_value = get_export<hostfxr_set_runtime_property_value_fn>(*lib, "hostfxr_set_runtime_property_value");
+    if (!set_runtime_property_value)
+        return tl::make_unexpected(set_runtime_property_value.error());
+
     auto config_path = plugin_path / STR("xpproxy.runtimeconfig.json");
     hostfxr_initialize_parameters init_parameters
     {
@@ -42,6 +97,7 @@ tl::expected<proxy, std::string> proxy::create(fs::path plugin_path) {
     };
     hostfxr_handle handle = nullptr;
 
+    trace_phase phase("initialize_runtime");
     auto result = (*initialize_for_runtime_config)(config_path.c_str(), &init_parameters, &handle);
 
     if (result < 0 || handle == nullptr)
@@ -50,9 +106,18 @@ tl::expected<proxy, std::string> proxy::create(fs::path plugin_path) {
         return tl::make_unexpected("Failed to load runtime.");
     }
 
+    for (auto& property : properties)
+    {
+        if ((*set_runtime_property_value)(handle, property.first.c_str(), property.second.c_str()) != 0)
+        {
+            (*close)(handle);
+            return tl::make_unexpected("Failed to set a runtime property.");
+        }
+    }
+
     void* load_assembly_and_get_function_pointer_ptr = nullptr;
     result = (*get_runtime_delegate)(handle, hdt_load_assembly_and_get_function_pointer, &load_assembly_and_get_function_pointer_ptr);
-    if (result != 0 || &load_assembly_and_get_function_pointer_ptr == nullptr) {
+    if (result != 0 || load_assembly_and_get_function_pointer_ptr == nullptr) {
         (*close)(handle);
         return tl::make_unexpected("Failed to load runtime.");
     }
@@ -60,36 +125,107 @@ tl::expected<proxy, std::string> proxy::create(fs::path plugin_path) {
     (*close)(handle);
 
     auto get_delegate = (load_assembly_and_get_function_pointer_fn)(load_assembly_and_get_function_pointer_ptr);
+    publish_shared_runtime(get_delegate);
+    return get_delegate;
+}
 
-    const fs::path assembly_path = plugin_path / string_t(STR("xpproxy.dll"));
-    const char_t* proxy_type = STR("XP.Proxy.PluginProxy, xpproxy");
-    void* delegate = nullptr;
-    
-    result = (*get_delegate)(assembly_path.c_str(), proxy_type, STR("XPluginStart"), STR("XP.Proxy.StartDelegate, xpproxy"), nullptr, &delegate);
-    if (result != 0 || delegate == nullptr)
-        return tl::make_unexpected("Failed to get XPluginStart");
-    auto plugin_start = (StartDelegate)delegate;
+proxy_backend proxy::get_backend(const fs::path& plugin_path, const string_t& plugin_name)
+{
+    // A NativeAOT plugin is shipped without xpproxy and its runtime config,
+    // and its native library is named after the plugin.
+    if (fs::exists(plugin_path / STR("xpproxy.runtimeconfig.json")))
+        return proxy_backend::clr;
 
-    result = (*get_delegate)(assembly_path.c_str(), proxy_type, STR("XPluginStop"), STR("XP.Proxy.StopDelegate, xpproxy"), nullptr, &delegate);
-    if (result != 0 || delegate == nullptr)
-        return tl::make_unexpected("Failed to get XPluginStop");
-    auto plugin_stop = (StopDelegate)delegate;
+    return fs::exists(plugin_path / (plugin_name + LIBRARY_EXTENSION))
+        ? proxy_backend::native_aot
+        : proxy_backend::clr;
+}
 
-    result = (*get_delegate)(assembly_path.c_str(), proxy_type, STR("XPluginEnable"), STR("XP.Proxy.EnableDelegate, xpproxy"), nullptr, &delegate);
-    if (result != 0 || delegate == nullptr)
-        return tl::make_unexpected("Failed to get XPluginEnable");
-    auto plugin_enable = (EnableDelegate)delegate;
+tl::expected<proxy, std::string> proxy::create(fs::path plugin_path, string_t plugin_name, runtime_properties properties)
+{
+    if (get_backend(plugin_path, plugin_name) == proxy_backend::native_aot)
+        return create_native_aot(plugin_path / (plugin_name + LIBRARY_EXTENSION));
 
-    result = (*get_delegate)(assembly_path.c_str(), proxy_type, STR("XPluginDisable"), STR("XP.Proxy.DisableDelegate, xpproxy"), nullptr, &delegate);
-    if (result != 0 || delegate == nullptr)
-        return tl::make_unexpected("Failed to get XPluginDisable");
-    auto plugin_disable = (DisableDelegate)delegate;
+    return create_clr(plugin_path, properties);
+}
 
-    result = (*get_delegate)(assembly_path.c_str(), proxy_type, STR("XPluginReceiveMessage"), STR("XP.Proxy.ReceiveMessageDelegate, xpproxy"), nullptr, &delegate);
-    if (result != 0 || delegate == nullptr)
-        return tl::make_unexpected("Failed to get XPluginReceiveMessage");
-    auto plugin_receive_message = (ReceiveMessageDelegate)delegate;
+tl::expected<proxy, std::string> proxy::create_native_aot(const fs::path& library_path)
+{
+    // NativeAOT libraries cannot be unloaded, so the library handle is never released.
+    trace_phase phase("load_native_aot_library");
+    auto lib = load_library(library_path.native());
+    if (!lib)
+        return tl::make_unexpected(lib.error());
 
-    bool success;
-    return std::move(proxy(plugin_start, plugin_stop, plugin_enable, plugin_disable, plugin_receive_message));
+    auto start = get_export<NativeStartDelegate>(*lib, "XPluginStart");
+    if (!start)
+        return tl::make_unexpected(start.error());
+
+    entry_points table {};
+    table.size = sizeof(entry_points);
+    auto stop = get_export<StopDelegate>(*lib, "XPluginStop");
+    auto enable = get_export<EnableDelegate>(*lib, "XPluginEnable");
+    auto disable = get_export<DisableDelegate>(*lib, "XPluginDisable");
+    auto receive_message = get_export<ReceiveMessageDelegate>(*lib, "XPluginReceiveMessage");
+    if (!stop || !enable || !disable || !receive_message)
+        return tl::make_unexpected("The NativeAOT plugin library does not export all the plugin entry points.");
+
+    table.stop = *stop;
+    table.enable = *enable;
+    table.disable = *disable;
+    table.receive_message = *receive_message;
+    return proxy(table, false, *start);
+}
+
+tl::expected<proxy, std::string> proxy::create_clr(const fs::path& plugin_path, const runtime_properties& properties)
+{
+    // CoreCLR can be loaded only once per process, so all managed plugins share it.
+    // The host loads each xpproxy.dll into its own isolated load context,
+    // so every plugin still gets its own copy of XP.Proxy, XP.SDK and PluginContext.
+    auto mutex_name = get_shared_runtime_mutex_name();
+    auto mutex = lock_process_mutex(mutex_name);
+    if (!mutex)
+        return tl::make_unexpected(mutex.error());
+
+    bool shared_runtime = true;
+    auto get_delegate = find_shared_runtime();
+    if (get_delegate == nullptr)
+    {
+        trace_phase phase("load_runtime");
+        auto runtime = load_runtime(plugin_path, properties);
+        if (!runtime)
+        {
+            // The next plugin tries to load the runtime, still under the mutex.
+            unlock_process_mutex(*mutex, mutex_name, false);
+            return tl::make_unexpected(runtime.error());
+        }
+
+        get_delegate = *runtime;
+        shared_runtime = false;
+    }
+    // Once the runtime is published, the variable is only read, so the mutex is no longer needed.
+    unlock_process_mutex(*mutex, mutex_name, true);
+
+    trace_phase phase("load_xpproxy");
+    const fs::path assembly_path = plugin_path / string_t(STR("xpproxy.dll"));
+    void* delegate = nullptr;
+    
+    int result = (*get_delegate)(assembly_path.c_str(), STR("XP.Proxy.PluginProxy, xpproxy"), STR("Bootstrap"), STR("XP.Proxy.BootstrapDelegate, xpproxy"), nullptr, &delegate);
+    if (result != 0 || delegate == nullptr)
+        return tl::make_unexpected("Failed to get Bootstrap");
+
+    entry_points table {};
+    table.size = sizeof(entry_points);
+    auto filled = ((BootstrapDelegate)delegate)(&table);
+    if (filled <= (int)sizeof(table.size) || filled > (int)sizeof(entry_points) || filled != table.size)
+        return tl::make_unexpected("Failed to get the plugin entry points.");
+
+    if (!HAS_ENTRY_POINT(table, start) ||
+        !HAS_ENTRY_POINT(table, stop) ||
+        !HAS_ENTRY_POINT(table, enable) ||
+        !HAS_ENTRY_POINT(table, disable) ||
+        !HAS_ENTRY_POINT(table, receive_message))
+        return tl::make_unexpected("The plugin entry point table is incomplete.");
+
+    return std::move(proxy(table, shared_runtime));
 }
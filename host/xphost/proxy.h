@@ -6,7 +6,11 @@
 #include <tl/expected.hpp>
 #include <XPLMDefs.h>
 
+#include <cstddef>
+
 #include "platform.h"
+#include "host_api.h"
+#include "gc_config.h"
 
 struct start_parameters
 {
@@ -15,6 +19,7 @@ struct start_parameters
     char* desc;
     const char* startup_path;
     const char* plugin_path;
+    const host_api* host;
 };
 
 typedef int (*StartDelegate)(start_parameters* params);
@@ -22,57 +27,96 @@ typedef int (*EnableDelegate)(void);
 typedef void (*DisableDelegate)(void);
 typedef void (*StopDelegate)(void);
 typedef void (*ReceiveMessageDelegate)(XPLMPluginID inFrom, int inMsg, void* inParam);
+typedef int (*NativeStartDelegate)(char* outName, char* outSig, char* outDesc);
+
+// The table of managed entry points filled by XP.Proxy.PluginProxy.Bootstrap in a single call.
+// The host passes the size of the table it knows about, and the proxy fills at most that many bytes
+// and returns the size it has filled, which it also stores in the size field, or 0 on failure.
+// New entry points must be appended to the end of the table.
+struct entry_points
+{
+    int size;
+    StartDelegate start;
+    StopDelegate stop;
+    EnableDelegate enable;
+    DisableDelegate disable;
+    ReceiveMessageDelegate receive_message;
+};
+
+typedef int (*BootstrapDelegate)(entry_points* table);
+
+#define HAS_ENTRY_POINT(table, field) \
+    ((table).size >= (int)(offsetof(entry_points, field) + sizeof(entry_points::field)) && (table).field != nullptr)
+
+enum class proxy_backend
+{
+    // The plugin is a managed assembly loaded by XP.Proxy in CoreCLR.
+    clr,
+    // The plugin is a NativeAOT-compiled library exporting the X-Plane plugin entry points.
+    native_aot
+};
 
 class proxy
 {
 private:
-    StartDelegate plugin_start;
-    StopDelegate plugin_stop;
-    EnableDelegate plugin_enable;
-    DisableDelegate plugin_disable;
-    ReceiveMessageDelegate plugin_receive_message;
-
-    proxy(
-        StartDelegate plugin_start,
-        StopDelegate plugin_stop,
-        EnableDelegate plugin_enable,
-        DisableDelegate plugin_disable,
-        ReceiveMessageDelegate plugin_receive_message)
+    entry_points table;
+    bool shared_runtime;
+    // NativeAOT plugins export XPluginStart with the X-Plane signature; the other entry points match the table.
+    NativeStartDelegate native_start;
+
+    proxy(const entry_points& table, bool shared_runtime, NativeStartDelegate native_start = nullptr)
         :
-        plugin_start(plugin_start),
-        plugin_stop(plugin_stop),
-        plugin_enable(plugin_enable),
-        plugin_disable(plugin_disable),
-        plugin_receive_message(plugin_receive_message)
+        table(table),
+        shared_runtime(shared_runtime),
+        native_start(native_start)
     {
     }
 
+    static load_assembly_and_get_function_pointer_fn find_shared_runtime();
+    static void publish_shared_runtime(load_assembly_and_get_function_pointer_fn get_delegate);
+    static tl::expected<load_assembly_and_get_function_pointer_fn, std::string> load_runtime(const fs::path& plugin_path, const runtime_properties& properties);
+    static tl::expected<proxy, std::string> create_clr(const fs::path& plugin_path, const runtime_properties& properties);
+    static tl::expected<proxy, std::string> create_native_aot(const fs::path& library_path);
     
 public:
-    static tl::expected<proxy, std::string> create(fs::path plugin_path);
+    static proxy_backend get_backend(const fs::path& plugin_path, const string_t& plugin_name);
+    // The runtime properties are applied only if the plugin is the first one to load the runtime.
+    static tl::expected<proxy, std::string> create(fs::path plugin_path, string_t plugin_name, runtime_properties properties = {});
+
+    proxy_backend backend() const
+    {
+        return native_start != nullptr ? proxy_backend::native_aot : proxy_backend::clr;
+    }
+
+    bool is_shared_runtime() const
+    {
+        return shared_runtime;
+    }
 
     int start(start_parameters* params)
     {
-        return plugin_start(params);
+        return native_start != nullptr
+            ? native_start(params->name, params->sig, params->desc)
+            : table.start(params);
     }
 
     void stop()
     {
-        plugin_stop();
+        table.stop();
     }
 
     int enable()
     {
-        return plugin_enable();
+        return table.enable();
     }
 
     void disable()
     {
-        return plugin_disable();
+        return table.disable();
     }
 
     void receive_message(XPLMPluginID inFrom, int inMsg, void* inParam)
     {
-        plugin_receive_message(inFrom, inMsg, inParam);
+        table.receive_message(inFrom, inMsg, inParam);
     }
 };
@@ -0,0 +1,95 @@
+#include "ready_to_run.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+static const uint32_t READYTORUN_SIGNATURE = 0x00525452; // 'RTR'
+static const int CLR_RUNTIME_HEADER_DIRECTORY = 14;
+
+template <typename T>
+static bool read_at(std::ifstream& stream, uint32_t offset, T& value)
+{
+    stream.seekg(offset);
+    stream.read((char*)&value, sizeof(T));
+    return (bool)stream;
+}
+
+struct section
+{
+    uint32_t virtual_size;
+    uint32_t virtual_address;
+    uint32_t raw_size;
+    uint32_t raw_offset;
+};
+
+static std::optional<uint32_t> rva_to_offset(const std::vector<section>& sections, uint32_t rva)
+{
+    for (auto& s : sections)
+    {
+        if (rva >= s.virtual_address && rva < s.virtual_address + std::max(s.virtual_size, s.raw_size))
+            return rva - s.virtual_address + s.raw_offset;
+    }
+    return std::nullopt;
+}
+
+std::optional<bool> is_ready_to_run_image(const fs::path& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return std::nullopt;
+
+    uint16_t dos_magic;
+    uint32_t pe_offset;
+    if (!read_at(stream, 0, dos_magic) || dos_magic != 0x5A4D || !read_at(stream, 0x3C, pe_offset))
+        return std::nullopt;
+
+    uint32_t pe_signature;
+    uint16_t section_count, optional_header_size, optional_magic;
+    if (!read_at(stream, pe_offset, pe_signature) || pe_signature != 0x00004550 ||
+        !read_at(stream, pe_offset + 6, section_count) ||
+        !read_at(stream, pe_offset + 20, optional_header_size))
+        return std::nullopt;
+
+    auto optional_header = pe_offset + 24;
+    if (!read_at(stream, optional_header, optional_magic))
+        return std::nullopt;
+
+    // Data directories start at offset 96 in PE32 and at offset 112 in PE32+ optional headers.
+    auto directories = optional_header + (optional_magic == 0x20B ? 112 : 96);
+    uint32_t cor_header_rva;
+    if (!read_at(stream, directories + CLR_RUNTIME_HEADER_DIRECTORY * 8, cor_header_rva) || cor_header_rva == 0)
+        return std::nullopt;
+
+    std::vector<section> sections(section_count);
+    auto section_headers = optional_header + optional_header_size;
+    for (uint16_t i = 0; i < section_count; i++)
+    {
+        // Skip the 8 byte section name.
+        if (!read_at(stream, section_headers + i * 40 + 8, sections[i]))
+            return std::nullopt;
+    }
+
+    auto cor_header = rva_to_offset(sections, cor_header_rva);
+    if (!cor_header)
+        return std::nullopt;
+
+    // ManagedNativeHeader directory of IMAGE_COR20_HEADER points to READYTORUN_HEADER in R2R images.
+    uint32_t native_header_rva;
+    if (!read_at(stream, *cor_header + 64, native_header_rva))
+        return std::nullopt;
+
+    if (native_header_rva == 0)
+        return false;
+
+    auto native_header = rva_to_offset(sections, native_header_rva);
+    uint32_t signature;
+    return native_header && read_at(stream, *native_header, signature) && signature == READYTORUN_SIGNATURE;
+}
+
+bool is_ready_to_run_disabled()
+{
+    return get_environment_variable("DOTNET_ReadyToRun") == "0" ||
+        get_environment_variable("COMPlus_ReadyToRun") == "0";
+}
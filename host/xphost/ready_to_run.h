@@ -0,0 +1,12 @@
+#pragma once
+
+#include <optional>
+
+#include "platform.h"
+
+// Checks whether the managed assembly has a ReadyToRun (precompiled) code header.
+// Returns an empty value if the file is missing or is not a managed PE image.
+std::optional<bool> is_ready_to_run_image(const fs::path& path);
+
+// Checks whether the use of ReadyToRun code is disabled for the runtime by the environment.
+bool is_ready_to_run_disabled();
@@ -0,0 +1,66 @@
+#include "settings.h"
+
+#include <cstdlib>
+#include <fstream>
+
+static std::string trim(const std::string& str)
+{
+    const char* whitespace = " \t\r\n";
+    auto begin = str.find_first_not_of(whitespace);
+    if (begin == std::string::npos)
+        return std::string();
+
+    auto end = str.find_last_not_of(whitespace);
+    return str.substr(begin, end - begin + 1);
+}
+
+settings settings::load(const fs::path& plugin_path)
+{
+    settings result;
+    std::ifstream stream(plugin_path / STR("xphost.ini"));
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';')
+            continue;
+
+        auto separator = line.find('=');
+        if (separator == std::string::npos)
+            continue;
+
+        result.values[trim(line.substr(0, separator))] = trim(line.substr(separator + 1));
+    }
+    return result;
+}
+
+bool settings::contains(const std::string& key) const
+{
+    return values.find(key) != values.end();
+}
+
+std::string settings::get_string(const std::string& key, const std::string& default_value) const
+{
+    auto value = values.find(key);
+    return value != values.end() ? value->second : default_value;
+}
+
+bool settings::get_bool(const std::string& key, bool default_value) const
+{
+    auto value = values.find(key);
+    if (value == values.end())
+        return default_value;
+
+    return value->second == "1" || value->second == "true" || value->second == "yes" || value->second == "on";
+}
+
+double settings::get_double(const std::string& key, double default_value) const
+{
+    auto value = values.find(key);
+    if (value == values.end())
+        return default_value;
+
+    char* end = nullptr;
+    auto result = strtod(value->second.c_str(), &end);
+    return end != value->second.c_str() ? result : default_value;
+}
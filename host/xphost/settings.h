@@ -0,0 +1,22 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "platform.h"
+
+// Host settings read from the xphost.ini sidecar file in the plugin folder.
+// The file contains "key = value" lines; empty lines and lines starting with '#' or ';' are ignored.
+class settings
+{
+private:
+    std::map<std::string, std::string> values;
+
+public:
+    static settings load(const fs::path& plugin_path);
+
+    bool contains(const std::string& key) const;
+    std::string get_string(const std::string& key, const std::string& default_value = std::string()) const;
+    bool get_bool(const std::string& key, bool default_value = false) const;
+    double get_double(const std::string& key, double default_value = 0) const;
+};
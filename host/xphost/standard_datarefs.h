@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "dataref_cache.h"
+
+// The datarefs of X-Plane which the plugins commonly use, whose hashes are added to the dataref cache at build time.
+static constexpr const char* STANDARD_DATAREF_NAMES[] =
+{
+    "sim/aircraft/view/acf_ICAO",
+    "sim/aircraft/view/acf_tailnum",
+    "sim/aircraft/engine/acf_num_engines",
+    "sim/aircraft/weight/acf_m_empty",
+    "sim/aircraft/weight/acf_m_max",
+    "sim/cockpit/autopilot/altitude",
+    "sim/cockpit/autopilot/autopilot_mode",
+    "sim/cockpit/autopilot/heading_mag",
+    "sim/cockpit/autopilot/vertical_velocity",
+    "sim/cockpit/electrical/avionics_on",
+    "sim/cockpit/electrical/battery_on",
+    "sim/cockpit/electrical/night_vision_on",
+    "sim/cockpit/gyros/psi_ind_ahars_pilot_degm",
+    "sim/cockpit/misc/barometer_setting",
+    "sim/cockpit/radios/com1_freq_hz",
+    "sim/cockpit/radios/com2_freq_hz",
+    "sim/cockpit/radios/nav1_freq_hz",
+    "sim/cockpit/radios/nav2_freq_hz",
+    "sim/cockpit/radios/transponder_code",
+    "sim/cockpit/switches/gear_handle_status",
+    "sim/cockpit2/autopilot/altitude_dial_ft",
+    "sim/cockpit2/autopilot/heading_dial_deg_mag_pilot",
+    "sim/cockpit2/autopilot/airspeed_dial_kts_mach",
+    "sim/cockpit2/autopilot/vvi_dial_fpm",
+    "sim/cockpit2/controls/flap_ratio",
+    "sim/cockpit2/controls/parking_brake_ratio",
+    "sim/cockpit2/controls/speedbrake_ratio",
+    "sim/cockpit2/engine/actuators/throttle_ratio",
+    "sim/cockpit2/engine/actuators/throttle_ratio_all",
+    "sim/cockpit2/engine/indicators/N1_percent",
+    "sim/cockpit2/engine/indicators/N2_percent",
+    "sim/cockpit2/gauges/indicators/airspeed_kts_pilot",
+    "sim/cockpit2/gauges/indicators/altitude_ft_pilot",
+    "sim/cockpit2/gauges/indicators/heading_electric_deg_mag_pilot",
+    "sim/cockpit2/gauges/indicators/pitch_AHARS_deg_pilot",
+    "sim/cockpit2/gauges/indicators/roll_AHARS_deg_pilot",
+    "sim/cockpit2/gauges/indicators/vvi_fpm_pilot",
+    "sim/cockpit2/radios/actuators/com1_frequency_hz_833",
+    "sim/cockpit2/radios/actuators/nav1_frequency_hz",
+    "sim/cockpit2/switches/avionics_power_on",
+    "sim/cockpit2/switches/landing_lights_on",
+    "sim/cockpit2/switches/navigation_lights_on",
+    "sim/cockpit2/switches/beacon_on",
+    "sim/cockpit2/switches/strobe_lights_on",
+    "sim/cockpit2/switches/taxi_light_on",
+    "sim/flightmodel/controls/flaprat",
+    "sim/flightmodel/controls/parkbrake",
+    "sim/flightmodel/controls/sbrkrat",
+    "sim/flightmodel/engine/ENGN_N1_",
+    "sim/flightmodel/engine/ENGN_running",
+    "sim/flightmodel/engine/ENGN_thro",
+    "sim/flightmodel/failures/onground_any",
+    "sim/flightmodel/forces/g_nrml",
+    "sim/flightmodel/misc/h_ind",
+    "sim/flightmodel/movingparts/gear1def",
+    "sim/flightmodel/position/alpha",
+    "sim/flightmodel/position/elevation",
+    "sim/flightmodel/position/groundspeed",
+    "sim/flightmodel/position/indicated_airspeed",
+    "sim/flightmodel/position/latitude",
+    "sim/flightmodel/position/local_vx",
+    "sim/flightmodel/position/local_vy",
+    "sim/flightmodel/position/local_vz",
+    "sim/flightmodel/position/local_x",
+    "sim/flightmodel/position/local_y",
+    "sim/flightmodel/position/local_z",
+    "sim/flightmodel/position/longitude",
+    "sim/flightmodel/position/mag_psi",
+    "sim/flightmodel/position/P",
+    "sim/flightmodel/position/phi",
+    "sim/flightmodel/position/psi",
+    "sim/flightmodel/position/Q",
+    "sim/flightmodel/position/q",
+    "sim/flightmodel/position/R",
+    "sim/flightmodel/position/theta",
+    "sim/flightmodel/position/true_airspeed",
+    "sim/flightmodel/position/vh_ind_fpm",
+    "sim/flightmodel/position/y_agl",
+    "sim/flightmodel/weight/m_fuel_total",
+    "sim/flightmodel/weight/m_total",
+    "sim/flightmodel2/gear/on_ground",
+    "sim/graphics/view/view_type",
+    "sim/graphics/view/view_x",
+    "sim/graphics/view/view_y",
+    "sim/graphics/view/view_z",
+    "sim/graphics/view/view_heading",
+    "sim/graphics/view/view_pitch",
+    "sim/graphics/view/view_roll",
+    "sim/graphics/view/window_height",
+    "sim/graphics/view/window_width",
+    "sim/operation/misc/frame_rate_period",
+    "sim/operation/override/override_joystick",
+    "sim/operation/override/override_planepath",
+    "sim/operation/prefs/startup_running",
+    "sim/time/local_date_days",
+    "sim/time/local_time_sec",
+    "sim/time/paused",
+    "sim/time/sim_speed",
+    "sim/time/total_flight_time_sec",
+    "sim/time/total_running_time_sec",
+    "sim/time/zulu_time_sec",
+    "sim/weather/barometer_sealevel_inhg",
+    "sim/weather/temperature_ambient_c",
+    "sim/weather/wind_direction_degt",
+    "sim/weather/wind_speed_kt",
+};
+
+static constexpr size_t STANDARD_DATAREF_COUNT = sizeof(STANDARD_DATAREF_NAMES) / sizeof(STANDARD_DATAREF_NAMES[0]);
+
+static constexpr std::array<uint64_t, STANDARD_DATAREF_COUNT> hash_standard_datarefs()
+{
+    std::array<uint64_t, STANDARD_DATAREF_COUNT> hashes {};
+    for (size_t i = 0; i < STANDARD_DATAREF_COUNT; i++)
+    {
+        hashes[i] = hash_dataref_name(STANDARD_DATAREF_NAMES[i]);
+    }
+    return hashes;
+}
+
+static constexpr std::array<uint64_t, STANDARD_DATAREF_COUNT> STANDARD_DATAREF_HASHES = hash_standard_datarefs();
+
+static constexpr bool has_distinct_hashes(const std::array<uint64_t, STANDARD_DATAREF_COUNT>& hashes)
+{
+    for (size_t i = 0; i < hashes.size(); i++)
+    {
+        for (size_t j = i + 1; j < hashes.size(); j++)
+        {
+            if (hashes[i] == hashes[j])
+                return false;
+        }
+    }
+    return true;
+}
+
+static_assert(has_distinct_hashes(STANDARD_DATAREF_HASHES), "The standard datarefs must be listed once and have distinct hashes.");
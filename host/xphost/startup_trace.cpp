@@ -0,0 +1,124 @@
+#include "startup_trace.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <XPLMUtilities.h>
+
+startup_trace::startup_trace() : origin(clock::now()), finished(false)
+{
+}
+
+startup_trace& startup_trace::instance()
+{
+    static startup_trace trace;
+    return trace;
+}
+
+startup_trace::thread_state& startup_trace::get_thread_state()
+{
+    auto id = std::this_thread::get_id();
+    for (auto& state : threads)
+    {
+        if (state.id == id)
+            return state;
+    }
+    threads.push_back(thread_state { id, {} });
+    return threads.back();
+}
+
+void startup_trace::begin(const char* name)
+{
+    auto now = clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished)
+        return;
+
+    auto& state = get_thread_state();
+    events.push_back(event { name, (int)(&state - threads.data()), (int)state.open_events.size(), now, now, false });
+    state.open_events.push_back(events.size() - 1);
+}
+
+void startup_trace::end()
+{
+    auto now = clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished)
+        return;
+
+    auto& state = get_thread_state();
+    if (state.open_events.empty())
+        return;
+
+    auto& e = events[state.open_events.back()];
+    e.end = now;
+    e.ended = true;
+    state.open_events.pop_back();
+}
+
+static double to_ms(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static std::string escape_json(const std::string& str)
+{
+    std::string result;
+    for (auto c : str)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if ((unsigned char)c >= 0x20)
+            result += c;
+    }
+    return result;
+}
+
+void startup_trace::emit(const fs::path& trace_file)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished)
+        return;
+
+    finished = true;
+    auto now = clock::now();
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "total=%.3f", to_ms(now - origin));
+    std::string line = "[xphost] Startup (ms):";
+    line += " ";
+    line += buffer;
+    for (auto& e : events)
+    {
+        // Phases that have not been ended are reported as lasting until now.
+        auto end = e.ended ? e.end : now;
+        snprintf(buffer, sizeof(buffer), "=%.3f", to_ms(end - e.begin));
+        line += " ";
+        line += std::string(e.depth, '>') + e.name + buffer;
+    }
+    line += ENDL;
+    XPLMDebugString(line.c_str());
+
+    if (trace_file.empty())
+        return;
+
+    std::ofstream stream(trace_file, std::ios::trunc);
+    if (!stream)
+    {
+        XPLMDebugString("[xphost] Failed to write the startup trace file." ENDL);
+        return;
+    }
+
+    auto pid = get_process_id();
+    stream << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        auto& e = events[i];
+        auto end = e.ended ? e.end : now;
+        auto ts = std::chrono::duration_cast<std::chrono::microseconds>(e.begin - origin).count();
+        auto dur = std::chrono::duration_cast<std::chrono::microseconds>(end - e.begin).count();
+        stream << (i > 0 ? "," : "") << "\n"
+            << "{\"name\":\"" << escape_json(e.name) << "\",\"cat\":\"startup\",\"ph\":\"X\""
+            << ",\"ts\":" << ts << ",\"dur\":" << dur << ",\"pid\":" << pid << ",\"tid\":" << e.thread << "}";
+    }
+    stream << "\n]}\n";
+}
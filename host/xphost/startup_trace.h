@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "platform.h"
+
+// Records the duration of the startup phases of the plugin, both native and managed ones.
+// The trace is written to the log as one line and, optionally, to a file in Chrome trace format.
+// Phases are nested per thread; the trace stops recording once it has been emitted.
+class startup_trace
+{
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct event
+    {
+        std::string name;
+        int thread;
+        int depth;
+        clock::time_point begin;
+        clock::time_point end;
+        bool ended;
+    };
+
+    struct thread_state
+    {
+        std::thread::id id;
+        std::vector<size_t> open_events;
+    };
+
+    std::mutex mutex;
+    clock::time_point origin;
+    std::vector<event> events;
+    std::vector<thread_state> threads;
+    bool finished;
+
+    startup_trace();
+    thread_state& get_thread_state();
+
+public:
+    static startup_trace& instance();
+
+    void begin(const char* name);
+    void end();
+    void emit(const fs::path& trace_file);
+};
+
+// Records a phase for the lifetime of the object.
+class trace_phase
+{
+public:
+    explicit trace_phase(const char* name)
+    {
+        startup_trace::instance().begin(name);
+    }
+
+    ~trace_phase()
+    {
+        startup_trace::instance().end();
+    }
+
+    trace_phase(const trace_phase&) = delete;
+    trace_phase& operator=(const trace_phase&) = delete;
+};
@@ -9,7 +9,20 @@
 
 #include "platform.h"
 #include "proxy.h"
+#include "settings.h"
+#include "ready_to_run.h"
+#include "startup_trace.h"
+#include "profiler.h"
+#include "frame_budget.h"
+#include "gc_config.h"
+#include "gc_telemetry.h"
+#include "dataref_snapshot.h"
+#include "dataref_writes.h"
+#include "dataref_cells.h"
+#include "dataref_cache.h"
 
+#include <cstring>
+#include <future>
 #include <optional>
 
 using namespace std;
@@ -37,52 +50,227 @@ BOOL APIENTRY DllMain(HANDLE hModule,
 
 std::optional<proxy> plugin_proxy;
 
-PLUGIN_API int XPluginStart(
-    char* outName,
-    char* outSig,
-    char* outDesc)
+// The state of the asynchronous start, see the async_start setting.
+std::future<tl::expected<proxy, std::string>> pending_proxy;
+std::string startup_path;
+std::string full_name;
+fs::path trace_file;
+runtime_properties gc_properties;
+
+static void log_error(const std::string& error)
+{
+    XPLMDebugString("[xphost] ");
+    XPLMDebugString(error.c_str());
+    XPLMDebugString(ENDL);
+}
+
+static void copy_info(char* dest, const std::string& value)
+{
+    // X-Plane provides 256 byte buffers for the plugin info.
+    strncpy(dest, value.c_str(), 255);
+    dest[255] = '\0';
+}
+
+static void report_precompiled_code(const fs::path& root_path)
+{
+    auto plugin_assembly = fs::u8path(full_name).replace_extension(STR(".dll"));
+    const fs::path assemblies[] = { root_path / STR("xpproxy.dll"), root_path / STR("XP.SDK.dll"), plugin_assembly };
+
+    // Only the image headers are read: the runtime may still reject the precompiled code, e.g. for another runtime
+    // version, and compile the methods with the JIT.
+    std::string report = "[xphost] Precompiled code:";
+    for (auto& assembly : assemblies)
+    {
+        auto ready_to_run = is_ready_to_run_image(assembly);
+        report += " " + assembly.filename().u8string() + "=" + (!ready_to_run ? "n/a" : *ready_to_run ? "has R2R image" : "IL only");
+    }
+    if (is_ready_to_run_disabled())
+    {
+        report += " (ReadyToRun code is disabled by the environment)";
+    }
+    report += ENDL;
+    XPLMDebugString(report.c_str());
+}
+
+static int start_proxy(char* outName, char* outSig, char* outDesc)
+{
+    if (plugin_proxy->backend() == proxy_backend::native_aot)
+    {
+        XPLMDebugString("[xphost] Using the NativeAOT plugin library." ENDL);
+    }
+    else
+    {
+        report_precompiled_code(get_plugin_path());
+    }
+
+    if (plugin_proxy->is_shared_runtime())
+    {
+        XPLMDebugString("[xphost] Attached to the .NET runtime loaded by another plugin." ENDL);
+        if (!gc_properties.empty())
+        {
+            XPLMDebugString("[xphost] The GC settings are ignored, because the runtime has been configured by the plugin which loaded it." ENDL);
+        }
+    }
+
+    start_parameters params {
+        outName,
+        outSig,
+        outDesc,
+        startup_path.c_str(),
+        full_name.c_str(),
+        get_host_api()
+    };
+
+    trace_phase phase("plugin_start");
+    return plugin_proxy->start(&params);
+}
+
+// Stops the services started with the plugin. X-Plane does not call XPluginStop when the start fails,
+// so the failed starts stop them too.
+static void stop_services()
+{
+    profiler::instance().disable();
+    frame_budget::instance().disable();
+    gc_telemetry::instance().disable();
+    dataref_snapshots::instance().stop();
+    dataref_writes::instance().stop();
+    dataref_cells::instance().stop();
+    dataref_cache::instance().stop();
+}
+
+static int start_plugin(char* outName, char* outSig, char* outDesc)
 {
     XPLMDebugString("[xphost] Loaded xphost." ENDL);
     XPLMEnableFeature("XPLM_USE_NATIVE_PATHS", 1);
     XPLMEnableFeature("XPLM_USE_NATIVE_WIDGET_WINDOWS", 1);
 
-    auto startup_path = get_startup_path().u8string();
-    auto full_name = get_plugin_full_name().u8string();
+    startup_path = get_startup_path().u8string();
+    full_name = get_plugin_full_name().u8string();
     auto root_path = get_plugin_path();
     if (root_path.empty())
     {
         XPLMDebugString("Failed to get plugin path.");
         return 0;
     }
+
+    auto plugin_name = get_plugin_full_name().stem().u8string();
+    auto plugin_name_native = get_plugin_full_name().stem().native();
+    auto host_settings = settings::load(root_path);
+    if (host_settings.get_bool("profile"))
+    {
+        profiler::instance().enable("xphost/" + plugin_name + "/callback_profile");
+    }
+    if (host_settings.contains("frame_budget_ms"))
+    {
+        frame_budget::instance().enable(host_settings.get_double("frame_budget_ms"), host_settings.get_bool("frame_budget_defer"));
+    }
+    if (host_settings.get_bool("gc_telemetry"))
+    {
+        gc_telemetry::instance().enable(host_settings.get_double("gc_log_pause_ms", 1));
+    }
+    // The queued writes are flushed and the snapshots are read before the flight loops of the managed plugin,
+    // which are created when it starts. The writes are flushed first, so that the snapshots see them.
+    dataref_writes::instance().start();
+    dataref_snapshots::instance().start();
+    dataref_cache::instance().start();
+    gc_properties = get_gc_properties(host_settings);
+    if (host_settings.contains("trace_file"))
+    {
+        trace_file = root_path / fs::u8path(host_settings.get_string("trace_file"));
+    }
+    if (host_settings.get_bool("async_start"))
+    {
+        // The runtime is loaded on a worker thread, while X-Plane continues loading other plugins.
+        // The plugin info is taken from xphost.ini, and the managed plugin is started in XPluginEnable,
+        // because the managed code may call XPLM, which is only allowed on the main thread.
+        // The copies of xphost starting at the same time find, load and publish the shared runtime one at a time,
+        // under the mutex taken by proxy::create, which also covers the environment variables read by nethost and hostfxr.
+        copy_info(outName, host_settings.get_string("name", plugin_name));
+        copy_info(outSig, host_settings.get_string("signature", "xplane-dotnet." + plugin_name));
+        copy_info(outDesc, host_settings.get_string("description"));
+        pending_proxy = std::async(std::launch::async, proxy::create, root_path, plugin_name_native, gc_properties);
+        return 1;
+    }
     
-    auto proxy_result = proxy::create(root_path);
+    auto proxy_result = proxy::create(root_path, plugin_name_native, gc_properties);
     if (!proxy_result)
     {
-        XPLMDebugString("[xphost] ");
-        XPLMDebugString(proxy_result.error().c_str());
-        XPLMDebugString(ENDL);
+        log_error(proxy_result.error());
+        stop_services();
         return 0;
     }
     plugin_proxy = *proxy_result;
+    if (!start_proxy(outName, outSig, outDesc))
+    {
+        plugin_proxy.reset();
+        stop_services();
+        return 0;
+    }
+    return 1;
+}
 
-    start_parameters params {
-        outName,
-        outSig,
-        outDesc,
-        startup_path.c_str(),
-        full_name.c_str()
-    };
-        
-    auto result = plugin_proxy->start(&params);
+PLUGIN_API int XPluginStart(
+    char* outName,
+    char* outSig,
+    char* outDesc)
+{
+    int result;
+    {
+        trace_phase phase("XPluginStart");
+        result = start_plugin(outName, outSig, outDesc);
+    }
+
+    // In the asynchronous mode the startup is complete only when the plugin is enabled.
+    if (!pending_proxy.valid())
+    {
+        startup_trace::instance().emit(trace_file);
+    }
     return result;
 }
 
+static bool complete_async_start()
+{
+    if (!pending_proxy.valid())
+        return plugin_proxy.has_value();
+
+    trace_phase phase("XPluginEnable");
+    auto proxy_result = pending_proxy.get();
+    if (!proxy_result)
+    {
+        log_error(proxy_result.error());
+        stop_services();
+        return false;
+    }
+
+    plugin_proxy = *proxy_result;
+    char name[256], sig[256], desc[256];
+    auto started = start_proxy(name, sig, desc);
+    startup_trace::instance().emit(trace_file);
+    if (!started)
+    {
+        log_error("Failed to start the plugin.");
+        plugin_proxy.reset();
+        stop_services();
+        return false;
+    }
+    return true;
+}
+
 PLUGIN_API void	XPluginStop(void)
 {
-    if (plugin_proxy.has_value())
+    // The writes queued since the plugin was disabled are applied while the managed datarefs still exist.
+    dataref_writes::instance().flush();
+    if (pending_proxy.valid())
+    {
+        // The plugin has never been enabled, so the managed plugin has not been started.
+        pending_proxy.wait();
+        pending_proxy = {};
+    }
+    else if (plugin_proxy.has_value())
     {
         plugin_proxy->stop();
     }
+    stop_services();
 }
 
 PLUGIN_API void XPluginDisable(void) 
@@ -91,15 +279,22 @@ PLUGIN_API void XPluginDisable(void)
     {
         plugin_proxy->disable();
     }
+    // A disabled plugin runs no flight loops, so the writes queued until now would otherwise wait for the stop.
+    dataref_writes::instance().flush();
+    profiler::instance().dump();
 }
 
 PLUGIN_API int  XPluginEnable(void)
 {
-    return plugin_proxy.has_value() ? plugin_proxy->enable() : 0;
+    return complete_async_start() ? plugin_proxy->enable() : 0;
 }
 
 PLUGIN_API void XPluginReceiveMessage(XPLMPluginID inFrom, int inMsg, void* inParam)
 {
+    if (inMsg == XPLM_MSG_DATAREFS_ADDED)
+    {
+        dataref_cache::instance().invalidate(true);
+    }
     if (plugin_proxy.has_value())
     {
         plugin_proxy->receive_message(inFrom, inMsg, inParam);
@@ -25,4 +25,7 @@ namespace XP.Proxy
 
     [UnmanagedFunctionPointer(CallingConvention.Cdecl, BestFitMapping = false, SetLastError = false)]
     internal delegate void ReceiveMessageDelegate(int pluginId, int message, IntPtr param);
+
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl, BestFitMapping = false, SetLastError = false)]
+    internal unsafe delegate int BootstrapDelegate(EntryPoints* entryPoints);
 }
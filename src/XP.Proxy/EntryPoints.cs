@@ -0,0 +1,18 @@
+﻿using System;
+
+namespace XP.Proxy
+{
+    /// <summary>
+    /// Mirrors the <c>entry_points</c> table of xphost.
+    /// New entry points must be appended to the end of the structure.
+    /// </summary>
+    internal struct EntryPoints
+    {
+        public int Size;
+        public IntPtr Start;
+        public IntPtr Stop;
+        public IntPtr Enable;
+        public IntPtr Disable;
+        public IntPtr ReceiveMessage;
+    }
+}
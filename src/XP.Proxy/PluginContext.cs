@@ -44,6 +44,23 @@ namespace XP.Proxy
         }
 
         protected override Assembly? Load(AssemblyName assemblyName)
+        {
+            // The assemblies resolved after the start are not traced, so the phase name is not built for them.
+            if (!StartupTrace.IsActive)
+                return Resolve(assemblyName);
+
+            StartupTrace.BeginPhase("resolve " + assemblyName.Name);
+            try
+            {
+                return Resolve(assemblyName);
+            }
+            finally
+            {
+                StartupTrace.EndPhase();
+            }
+        }
+
+        private Assembly? Resolve(AssemblyName assemblyName)
         {
             var path = _resolver.ResolveAssemblyToPath(assemblyName);
             if (path != null)
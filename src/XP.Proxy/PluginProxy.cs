@@ -17,9 +17,39 @@ namespace XP.Proxy
         private static PluginBase _plugin;
         private static bool _resolverInitialized;
 
+        // The delegates are kept in static fields, so that the function pointers handed to the host stay valid.
+        private static readonly StartDelegate _start = XPluginStart;
+        private static readonly StopDelegate _stop = XPluginStop;
+        private static readonly EnableDelegate _enable = XPluginEnable;
+        private static readonly DisableDelegate _disable = XPluginDisable;
+        private static readonly ReceiveMessageDelegate _receiveMessage = XPluginReceiveMessage;
+
+        public static unsafe int Bootstrap(EntryPoints* entryPoints)
+        {
+            var table = new EntryPoints
+            {
+                Size = sizeof(EntryPoints),
+                Start = Marshal.GetFunctionPointerForDelegate(_start),
+                Stop = Marshal.GetFunctionPointerForDelegate(_stop),
+                Enable = Marshal.GetFunctionPointerForDelegate(_enable),
+                Disable = Marshal.GetFunctionPointerForDelegate(_disable),
+                ReceiveMessage = Marshal.GetFunctionPointerForDelegate(_receiveMessage)
+            };
+
+            // The host may be older or newer than the proxy, so only the common part of the table is filled.
+            var size = Math.Min(entryPoints->Size, table.Size);
+            if (size <= sizeof(int))
+                return 0;
+
+            table.Size = size;
+            Buffer.MemoryCopy(&table, entryPoints, size, size);
+            return size;
+        }
+
         public static int XPluginStart(ref StartParameters parameters)
         {
             GlobalContext.StartupPath = Marshal.PtrToStringUTF8(parameters.StartupPath);
+            HostAPI.Initialize(parameters.Host);
 
             var pluginPath = Marshal.PtrToStringUTF8(parameters.PluginPath);
             if (string.IsNullOrEmpty(pluginPath))
@@ -28,6 +58,8 @@ namespace XP.Proxy
                 return 0;
             }
 
+            GCTelemetry.Start();
+
             var assemblyPath = Path.ChangeExtension(pluginPath, ".dll");
             var currentContext = AssemblyLoadContext.GetLoadContext(Assembly.GetExecutingAssembly());
             if (!_resolverInitialized)
@@ -39,24 +71,65 @@ namespace XP.Proxy
             _context = new PluginContext(currentContext, assemblyPath);
             try
             {
-                var assembly = _context.LoadFromAssemblyPath(assemblyPath);
+                Assembly assembly;
+                StartupTrace.BeginPhase("load_plugin_assembly");
+                try
+                {
+                    assembly = _context.LoadFromAssemblyPath(assemblyPath);
+                }
+                finally
+                {
+                    StartupTrace.EndPhase();
+                }
+
                 var attr = assembly.GetCustomAttribute<PluginAttribute>();
                 if (attr == null)
                 {
                     UtilitiesAPI.DebugString($"Plugin assembly {assemblyPath} does not have '{typeof(PluginAttribute).FullName}' attribute defined.{Environment.NewLine}");
+                    GCTelemetry.Stop();
                     return 0;
                 }
 
-                _plugin = (PluginBase) Activator.CreateInstance(attr.PluginType);
+                StartupTrace.BeginPhase("create_plugin");
+                try
+                {
+                    _plugin = (PluginBase) Activator.CreateInstance(attr.PluginType);
+                }
+                finally
+                {
+                    StartupTrace.EndPhase();
+                }
+
                 WriteUtf8String(_plugin.Name, parameters.Name);
                 WriteUtf8String(_plugin.Signature, parameters.Sig);
                 WriteUtf8String(_plugin.Description, parameters.Desc);
                 GlobalContext.CurrentPlugin = new WeakReference<PluginBase>(_plugin);
-                return _plugin.Start() ? 1 : 0;
+
+                bool started;
+                StartupTrace.BeginPhase("on_start");
+                try
+                {
+                    started = _plugin.Start();
+                }
+                finally
+                {
+                    StartupTrace.EndPhase();
+                    StartupTrace.Complete();
+                }
+
+                if (!started)
+                {
+                    GCTelemetry.Stop();
+                    Unload();
+                    return 0;
+                }
+
+                return 1;
             }
             catch (Exception ex)
             {
                 UtilitiesAPI.DebugString(ex.ToString());
+                GCTelemetry.Stop();
                 Unload();
                 return 0;
             }
@@ -72,6 +145,7 @@ namespace XP.Proxy
         public static void XPluginStop()
         {
             _plugin.Stop();
+            GCTelemetry.Stop();
             Unload();
         }
 
@@ -12,5 +12,6 @@ namespace XP.Proxy
         public IntPtr Desc;
         public IntPtr StartupPath;
         public IntPtr PluginPath;
+        public IntPtr Host;
     }
 }
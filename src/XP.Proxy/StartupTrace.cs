@@ -0,0 +1,40 @@
+﻿using System;
+using XP.SDK.XPLM.Internal;
+
+namespace XP.Proxy
+{
+    /// <summary>
+    /// Records the managed startup phases in the startup trace of xphost.
+    /// </summary>
+    internal static class StartupTrace
+    {
+        private static bool _completed;
+
+        /// <summary>
+        /// Gets the value indicating whether the phases are recorded: the trace is supported by xphost,
+        /// and the plugin has not completed its start yet.
+        /// </summary>
+        public static bool IsActive => !_completed && HostAPI.IsTracingSupported;
+
+        /// <summary>
+        /// Ends the recording of the phases once the plugin has started.
+        /// </summary>
+        public static void Complete() => _completed = true;
+
+        public static void BeginPhase(string name)
+        {
+            if (HostAPI.IsTracingSupported)
+            {
+                HostAPI.BeginPhase(name);
+            }
+        }
+
+        public static void EndPhase()
+        {
+            if (HostAPI.IsTracingSupported)
+            {
+                HostAPI.EndPhase();
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+﻿using System;
+using System.Diagnostics;
+using System.Runtime.CompilerServices;
+using XP.SDK.XPLM.Internal;
+
+namespace XP.SDK
+{
+    /// <summary>
+    /// Measures the time spent in the managed callbacks invoked by X-Plane, when the callback profiling
+    /// or the frame budget watchdog is enabled in xphost.
+    /// The samples are written directly to the counters owned by xphost, so the measurement does not cross the interop boundary.
+    /// </summary>
+    internal readonly unsafe struct CallbackProfile
+    {
+        private static readonly double _nanosecondsPerTick = 1e9 / Stopwatch.Frequency;
+        private static readonly FrameBudgetState* _frameBudget = HostAPI.IsFrameBudgetSupported ? HostAPI.GetFrameBudget() : null;
+
+        // Callbacks may be nested, e.g. a command executed from a flight loop, and only the outermost one is added to the frame time.
+        // The callers end the measurement in a finally block, so that an exception does not leave the depth unbalanced.
+        private static int _depth;
+
+        private readonly ProfileSlot* _slot;
+        private readonly int _site;
+
+        private CallbackProfile(ProfileSlot* slot, int site)
+        {
+            _slot = slot;
+            _site = site;
+        }
+
+        public static CallbackProfile Register(string kind, string name) =>
+            new CallbackProfile(
+                HostAPI.IsProfilingSupported ? HostAPI.RegisterProfileSlot(kind, name) : null,
+                _frameBudget != null ? HostAPI.RegisterBudgetSite(kind, name) : -1);
+
+        /// <summary>
+        /// Gets the value indicating whether the callback should be skipped in this frame, if it is deferrable,
+        /// because it was the slowest callback of the previous frame, which has exceeded the budget.
+        /// </summary>
+        public bool IsOverBudget => _site >= 0 && _frameBudget->DeferEnabled != 0 && _frameBudget->DeferredSite == _site;
+
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public long Begin()
+        {
+            if (_slot == null && _site < 0)
+                return 0;
+
+            _depth++;
+            return Stopwatch.GetTimestamp();
+        }
+
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public void End(long timestamp)
+        {
+            if (_slot == null && _site < 0)
+                return;
+
+            var nanoseconds = (long) ((Stopwatch.GetTimestamp() - timestamp) * _nanosecondsPerTick);
+            if (_slot != null)
+            {
+                _slot->Record(nanoseconds);
+            }
+            if (--_depth == 0 && _site >= 0)
+            {
+                _frameBudget->Record(_site, nanoseconds);
+            }
+        }
+    }
+}
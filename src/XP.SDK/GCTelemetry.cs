@@ -0,0 +1,106 @@
+﻿using System;
+using System.Diagnostics.Tracing;
+using System.Threading;
+using XP.SDK.XPLM.Internal;
+
+#nullable enable
+
+namespace XP.SDK
+{
+    /// <summary>
+    /// Collects the garbage collections and their pauses from the runtime events, when the GC telemetry is enabled in xphost.
+    /// The counters are written to the structure owned by xphost, which reports them per frame.
+    /// </summary>
+    internal sealed unsafe class GCTelemetry : EventListener
+    {
+        private const string RuntimeEventSource = "Microsoft-Windows-DotNETRuntime";
+        private const EventKeywords GCKeyword = (EventKeywords) 0x1;
+
+        private const int GCStartEventId = 1;
+        private const int GCRestartEEEndEventId = 3;
+        private const int GCSuspendEEBeginEventId = 9;
+
+        private static GCTelemetry? _instance;
+
+        // The state is set before the listener is created, because the events may be enabled from the base constructor.
+        private static GCTelemetryState* _state;
+
+        // The suspension and the restart of a collection may be dispatched on different threads.
+        private long _suspendTimestamp;
+
+        public static void Start()
+        {
+            if (_instance != null || !HostAPI.IsGCTelemetrySupported)
+                return;
+
+            _state = HostAPI.GetGCTelemetry();
+            if (_state != null)
+            {
+                _instance = new GCTelemetry();
+            }
+        }
+
+        public static void Stop()
+        {
+            _instance?.Dispose();
+            _instance = null;
+            _state = null;
+        }
+
+        protected override void OnEventSourceCreated(EventSource eventSource)
+        {
+            if (eventSource.Name == RuntimeEventSource)
+            {
+                EnableEvents(eventSource, EventLevel.Informational, GCKeyword);
+            }
+        }
+
+        protected override void OnEventWritten(EventWrittenEventArgs eventData)
+        {
+            var state = _state;
+            if (state == null)
+                return;
+
+            switch (eventData.EventId)
+            {
+                case GCStartEventId:
+                    var generation = Convert.ToInt32(eventData.Payload![1]);
+                    if (generation >= 0 && generation < GCCounters.Generations)
+                    {
+                        Interlocked.Increment(ref state->Total.Collections[generation]);
+                    }
+                    break;
+
+                case GCSuspendEEBeginEventId:
+                    Volatile.Write(ref _suspendTimestamp, eventData.TimeStamp.Ticks);
+                    break;
+
+                case GCRestartEEEndEventId:
+                    var suspendTimestamp = Interlocked.Exchange(ref _suspendTimestamp, 0);
+                    if (suspendTimestamp == 0)
+                        break;
+
+                    var pause = (eventData.TimeStamp.Ticks - suspendTimestamp) * 100;
+                    Interlocked.Increment(ref state->Total.PauseCount);
+                    Interlocked.Add(ref state->Total.PauseTotalNanoseconds, pause);
+                    RaiseMax(ref state->Total.PauseMaxNanoseconds, pause);
+                    RaiseMax(ref state->FramePauseMaxNanoseconds, pause);
+                    break;
+            }
+        }
+
+        // The events may be written on several threads at once, so a maximum is only replaced by a greater value.
+        private static void RaiseMax(ref long max, long value)
+        {
+            var current = Volatile.Read(ref max);
+            while (value > current)
+            {
+                var previous = Interlocked.CompareExchange(ref max, value, current);
+                if (previous == current)
+                    return;
+
+                current = previous;
+            }
+        }
+    }
+}
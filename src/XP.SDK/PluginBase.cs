@@ -61,9 +61,16 @@ namespace XP.SDK
 
         protected abstract void OnReceiveMessage(PluginID pluginId, int message, IntPtr param);
 
-        internal static void RegisterObject(object obj)
+        // The objects are released when the plugin is stopped. Returns false if the plugin is not started,
+        // in which case the object is not registered.
+        internal static bool RegisterObject(object obj)
         {
-            _registeredObjects.Push(obj);
+            var registeredObjects = _registeredObjects;
+            if (registeredObjects == null)
+                return false;
+
+            registeredObjects.Push(obj);
+            return true;
         }
 
         private void ReleaseRegisteredObjects()
@@ -23,6 +23,8 @@ namespace XP.SDK.Widgets
     {
         private static readonly WidgetFuncCallback _customWidgetCallback;
 
+        private readonly CallbackProfile _profile;
+
         static CustomWidget()
         {
             _customWidgetCallback = CustomWidgetCallback;
@@ -33,7 +35,15 @@ namespace XP.SDK.Widgets
                 {
                     if (TryGetById(inwidget, out var widget) && widget is CustomWidget customWidget)
                     {
-                        return customWidget.HandleMessage(inmessage, inparam1, inparam2).ToInt();
+                        var timestamp = customWidget._profile.Begin();
+                        try
+                        {
+                            return customWidget.HandleMessage(inmessage, inparam1, inparam2).ToInt();
+                        }
+                        finally
+                        {
+                            customWidget._profile.End(timestamp);
+                        }
                     }
                 }
                 finally
@@ -59,6 +69,7 @@ namespace XP.SDK.Widgets
         /// <param name="isRoot">The value indicating whether this widget is a root one.</param>
         protected CustomWidget(in Rect geometry, string descriptor, bool isVisible, Widget? parent, bool isRoot) : base(isRoot, parent)
         {
+            _profile = CallbackProfile.Register("widget", GetType().FullName!);
             var id = WidgetsAPI.CreateCustomWidget(
                 geometry.Left,
                 geometry.Top,
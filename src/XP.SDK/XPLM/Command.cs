@@ -24,19 +24,37 @@ namespace XP.SDK.XPLM
         private InStructEventHandler<Command, CommandAfterExecuteEventArgs>? _afterExecute;
 
         private readonly CommandRef _commandRef;
+        private readonly string _name;
+        // The profile is registered with the first handler, since most of the commands are only found to be executed.
+        private CallbackProfile _profile;
+        private bool _profileRegistered;
+
+        // The handle is allocated while a handler is registered, and freed when the last one is unregistered
+        // or the plugin is stopped, so that the cached commands do not keep the plugin loaded.
+        private GCHandle _handle;
+        private bool _releasedOnStop;
 
         static unsafe Command()
         {
             _beforeExecuteCallback = BeforeExecuteCallback;
             _afterExecuteCallback = AfterExecuteCallback;
 
+            // The refcon is the handle of the command, so the dispatch does not look up the command cache.
             static int BeforeExecuteCallback(CommandRef incommand, CommandPhase inphase, void* inrefcon)
             {
-                if (_commandCache.TryGetValue(incommand, out var command) && command != null)
+                if (GCHandle.FromIntPtr(new IntPtr(inrefcon)).Target is Command command)
                 {
-                    var args = new CommandBeforeExecuteEventArgs(inphase);
-                    command._beforeExecute?.Invoke(command, ref args);
-                    return args.Handled ? 0 : 1;
+                    var timestamp = command._profile.Begin();
+                    try
+                    {
+                        var args = new CommandBeforeExecuteEventArgs(inphase);
+                        command._beforeExecute?.Invoke(command, ref args);
+                        return args.Handled ? 0 : 1;
+                    }
+                    finally
+                    {
+                        command._profile.End(timestamp);
+                    }
                 }
 
                 return 1;
@@ -44,30 +62,90 @@ namespace XP.SDK.XPLM
 
             static int AfterExecuteCallback(CommandRef incommand, CommandPhase inphase, void* inrefcon)
             {
-                if (_commandCache.TryGetValue(incommand, out var command) && command != null)
+                if (GCHandle.FromIntPtr(new IntPtr(inrefcon)).Target is Command command)
                 {
-                    var args = new CommandAfterExecuteEventArgs(inphase);
-                    command._afterExecute?.Invoke(command, in args);
+                    var timestamp = command._profile.Begin();
+                    try
+                    {
+                        var args = new CommandAfterExecuteEventArgs(inphase);
+                        command._afterExecute?.Invoke(command, in args);
+                    }
+                    finally
+                    {
+                        command._profile.End(timestamp);
+                    }
                 }
 
                 return 1;
             }
         }
 
-        private Command(CommandRef commandRef)
+        private Command(CommandRef commandRef, in ReadOnlySpan<char> name)
         {
             _commandRef = commandRef;
+            _name = name.ToString();
+        }
+
+        private unsafe void* Refcon => GCHandle.ToIntPtr(_handle).ToPointer();
+
+        private unsafe void* AcquireRefcon()
+        {
+            if (!_profileRegistered)
+            {
+                _profile = CallbackProfile.Register("command", _name);
+                _profileRegistered = true;
+            }
+
+            if (!_handle.IsAllocated)
+            {
+                _handle = GCHandle.Alloc(this);
+                if (!_releasedOnStop)
+                {
+                    // Outside of the plugin start and stop the handlers are only released when they are removed.
+                    _releasedOnStop = PluginBase.RegisterObject(new HandlerRelease(this));
+                }
+            }
+
+            return Refcon;
+        }
+
+        private void ReleaseUnusedHandle()
+        {
+            if (_beforeExecute == null && _afterExecute == null && _handle.IsAllocated)
+            {
+                _handle.Free();
+            }
+        }
+
+        private unsafe void UnregisterHandlers()
+        {
+            if (!_handle.IsAllocated)
+                return;
+
+            if (_beforeExecute != null)
+            {
+                UtilitiesAPI.UnregisterCommandHandler(_commandRef, _beforeExecuteCallback, 1, Refcon);
+                _beforeExecute = null;
+            }
+
+            if (_afterExecute != null)
+            {
+                UtilitiesAPI.UnregisterCommandHandler(_commandRef, _afterExecuteCallback, 0, Refcon);
+                _afterExecute = null;
+            }
+
+            _handle.Free();
         }
 
         [MethodImpl(MethodImplOptions.AggressiveInlining)]
-        private static Command? FromRef(CommandRef commandRef)
+        private static Command? FromRef(CommandRef commandRef, in ReadOnlySpan<char> name)
         {
             if (commandRef == default)
                 return null;
 
             if (!_commandCache.TryGetValue(commandRef, out var command))
             {
-                _commandCache[commandRef] = command = new Command(commandRef);
+                _commandCache[commandRef] = command = new Command(commandRef, name);
             }
 
             return command;
@@ -84,7 +162,7 @@ namespace XP.SDK.XPLM
         public static Command? Find(in ReadOnlySpan<char> name)
         {
             var commandRef = UtilitiesAPI.FindCommand(name);
-            return FromRef(commandRef);
+            return FromRef(commandRef, name);
         }
 
         /// <summary>
@@ -95,7 +173,7 @@ namespace XP.SDK.XPLM
         public static Command? Create(in ReadOnlySpan<char> name, in ReadOnlySpan<char> description)
         {
             var commandRef = UtilitiesAPI.CreateCommand(name, description);
-            return FromRef(commandRef);
+            return FromRef(commandRef, name);
         }
 
         /// <summary>
@@ -156,7 +234,7 @@ namespace XP.SDK.XPLM
                 _beforeExecute += value;
                 if (mustRegister)
                 {
-                    UtilitiesAPI.RegisterCommandHandler(_commandRef, _beforeExecuteCallback, 1, null);
+                    UtilitiesAPI.RegisterCommandHandler(_commandRef, _beforeExecuteCallback, 1, AcquireRefcon());
                 }
             }
             remove
@@ -166,7 +244,8 @@ namespace XP.SDK.XPLM
                     _beforeExecute -= value;
                     if (_beforeExecute == null)
                     {
-                        UtilitiesAPI.UnregisterCommandHandler(_commandRef, _beforeExecuteCallback, 1, null);
+                        UtilitiesAPI.UnregisterCommandHandler(_commandRef, _beforeExecuteCallback, 1, Refcon);
+                        ReleaseUnusedHandle();
                     }
                 }
             }
@@ -186,7 +265,7 @@ namespace XP.SDK.XPLM
                 _afterExecute += value;
                 if (mustRegister)
                 {
-                    UtilitiesAPI.RegisterCommandHandler(_commandRef, _afterExecuteCallback, 0, null);
+                    UtilitiesAPI.RegisterCommandHandler(_commandRef, _afterExecuteCallback, 0, AcquireRefcon());
                 }
             }
             remove
@@ -196,12 +275,30 @@ namespace XP.SDK.XPLM
                     _afterExecute -= value;
                     if (_afterExecute == null)
                     {
-                        UtilitiesAPI.UnregisterCommandHandler(_commandRef, _afterExecuteCallback, 0, null);
+                        UtilitiesAPI.UnregisterCommandHandler(_commandRef, _afterExecuteCallback, 0, Refcon);
+                        ReleaseUnusedHandle();
                     }
                 }
             }
         }
 
+        // Unregisters the handlers left by the plugin when it is stopped.
+        private sealed class HandlerRelease : IDisposable
+        {
+            private readonly Command _command;
+
+            public HandlerRelease(Command command)
+            {
+                _command = command;
+            }
+
+            public void Dispose()
+            {
+                _command._releasedOnStop = false;
+                _command.UnregisterHandlers();
+            }
+        }
+
         private class CommandDisposableScope : IDisposable
         {
             private CommandRef _commandRef;
@@ -99,5 +99,10 @@ namespace XP.SDK.XPLM
         public bool CheckIsGood() => DataAccessAPI.IsDataRefGood(this) != 0;
 
         public static DataRef Find(in ReadOnlySpan<char> name) => DataAccessAPI.FindDataRef(name);
+
+        /// <summary>
+        /// Finds the dataref by its name and precomputed hash, through the dataref cache of the host.
+        /// </summary>
+        public static DataRef Find(in DataRefName name) => name.Find();
     }
 }
@@ -0,0 +1,253 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using System.Threading;
+using XP.SDK.XPLM.Internal;
+
+namespace XP.SDK.XPLM
+{
+    /// <summary>
+    /// A dataref published by the plugin, whose value is kept in native memory.
+    /// </summary>
+    /// <remarks>
+    /// <para>
+    /// With a host which supports the cells, the dataref accessors are native functions of the host, which read and write
+    /// the memory directly, so the reads of the other plugins and of X-Plane never call the managed code.
+    /// The plugin updates the value in place, e.g. once per frame. Otherwise the cell is served by a <see cref="DataRefSource"/>.
+    /// </para>
+    /// <para>
+    /// The type must be exactly one of the <see cref="DataTypeID"/> values. An array or data cell has a fixed capacity,
+    /// of which the first <see cref="Length"/> elements or bytes are published.
+    /// </para>
+    /// </remarks>
+    public sealed unsafe class DataRefCell : IDisposable
+    {
+        private readonly CellSource _source;
+        private DataRefCellState* _state;
+        private int _disposed;
+
+        public DataRefCell(string name, DataTypeID type, int capacity = 1, bool isWriteable = false)
+        {
+            if (name == null)
+                throw new ArgumentNullException(nameof(name));
+            if (!IsSupported(type))
+                throw new ArgumentException("The type must be exactly one of the DataTypeID values.", nameof(type));
+            if (capacity < 0)
+                throw new ArgumentOutOfRangeException(nameof(capacity));
+
+            if (HostAPI.IsDataRefCellSupported)
+            {
+                _state = HostAPI.CreateDataRefCell(name, type, capacity, isWriteable.ToInt());
+                if (_state == null)
+                    throw new InvalidOperationException($"The dataref {name} cannot be registered.");
+            }
+            else
+            {
+                _state = AllocateState(type, capacity);
+                _source = new CellSource(name, type, isWriteable, _state);
+                _state->DataRef = DataAccessAPI.FindDataRef(name);
+            }
+        }
+
+        public DataRef DataRef => CheckState()->DataRef;
+
+        public DataTypeID Type => CheckState()->Type;
+
+        /// <summary>
+        /// Gets the number of the array elements or bytes the cell can hold, or 1 for the other types.
+        /// </summary>
+        public int Capacity => CheckState()->Capacity;
+
+        /// <summary>
+        /// Gets or sets the number of the published array elements or bytes, which is initially the capacity.
+        /// </summary>
+        public int Length
+        {
+            get => CheckState()->Length;
+            set
+            {
+                var state = CheckState();
+                if ((uint) value > (uint) state->Capacity)
+                    throw new ArgumentOutOfRangeException(nameof(value));
+                state->Length = value;
+            }
+        }
+
+        /// <summary>
+        /// Gets the number of the writes made through the dataref by the other plugins or X-Plane.
+        /// </summary>
+        public long Writes => CheckState()->Writes;
+
+        public int Int32Value
+        {
+            get => *(int*) GetValues(DataTypeID.Int);
+            set => *(int*) GetValues(DataTypeID.Int) = value;
+        }
+
+        public float SingleValue
+        {
+            get => *(float*) GetValues(DataTypeID.Float);
+            set => *(float*) GetValues(DataTypeID.Float) = value;
+        }
+
+        public double DoubleValue
+        {
+            get => *(double*) GetValues(DataTypeID.Double);
+            set => *(double*) GetValues(DataTypeID.Double) = value;
+        }
+
+        /// <summary>
+        /// Gets the whole capacity of an int array cell, which the plugin updates in place.
+        /// </summary>
+        public Span<int> Int32Values => new Span<int>(GetValues(DataTypeID.IntArray), _state->Capacity);
+
+        /// <summary>
+        /// Gets the whole capacity of a float array cell, which the plugin updates in place.
+        /// </summary>
+        public Span<float> SingleValues => new Span<float>(GetValues(DataTypeID.FloatArray), _state->Capacity);
+
+        /// <summary>
+        /// Gets the whole capacity of a data cell, which the plugin updates in place.
+        /// </summary>
+        public Span<byte> Bytes => new Span<byte>(GetValues(DataTypeID.Data), _state->Capacity);
+
+        private void* GetValues(DataTypeID type)
+        {
+            var state = CheckState();
+            if (state->Type != type)
+                throw new InvalidOperationException($"The dataref is {state->Type}, not {type}.");
+            return state->Values;
+        }
+
+        private DataRefCellState* CheckState() => _state != null ? _state : throw new ObjectDisposedException(nameof(DataRefCell));
+
+        private static bool IsSupported(DataTypeID type) => type switch
+        {
+            DataTypeID.Int => true,
+            DataTypeID.Float => true,
+            DataTypeID.Double => true,
+            DataTypeID.FloatArray => true,
+            DataTypeID.IntArray => true,
+            DataTypeID.Data => true,
+            _ => false
+        };
+
+        /// <summary>
+        /// Allocates the state with the layout of the host cells: the state, followed by the 8 byte aligned values.
+        /// </summary>
+        private static DataRefCellState* AllocateState(DataTypeID type, int capacity)
+        {
+            var isArray = type == DataTypeID.FloatArray || type == DataTypeID.IntArray || type == DataTypeID.Data;
+            capacity = isArray ? capacity : 1;
+            var size = type switch
+            {
+                DataTypeID.Double => 8,
+                DataTypeID.Data => capacity,
+                _ => capacity * 4
+            };
+
+            var valuesStart = (sizeof(DataRefCellState) + 7) & -8;
+            var blockSize = valuesStart + Math.Max(size, 8);
+            var start = (byte*) Marshal.AllocHGlobal(blockSize);
+            new Span<byte>(start, blockSize).Clear();
+            var state = (DataRefCellState*) start;
+            state->Type = type;
+            state->Capacity = capacity;
+            state->Length = capacity;
+            state->Values = start + valuesStart;
+            return state;
+        }
+
+        public void Dispose()
+        {
+            if (Interlocked.CompareExchange(ref _disposed, 1, 0) != 0)
+                return;
+
+            if (_source == null)
+            {
+                HostAPI.DestroyDataRefCell(_state);
+            }
+            else
+            {
+                _source.Dispose();
+                Marshal.FreeHGlobal((IntPtr) _state);
+            }
+            _state = null;
+        }
+
+        /// <summary>
+        /// Serves the cell through the managed accessors, with the semantics of the native accessors of the host.
+        /// </summary>
+        private sealed class CellSource : DataRefSource
+        {
+            private readonly DataRefCellState* _state;
+
+            public CellSource(string name, DataTypeID type, bool isWriteable, DataRefCellState* state) : base(name, type, isWriteable)
+            {
+                _state = state;
+            }
+
+            protected override int Int32Value
+            {
+                get => *(int*) _state->Values;
+                set => Write(value);
+            }
+
+            protected override float SingleValue
+            {
+                get => *(float*) _state->Values;
+                set => Write(value);
+            }
+
+            protected override double DoubleValue
+            {
+                get => *(double*) _state->Values;
+                set => Write(value);
+            }
+
+            protected override int ReadValues(in Span<int> buffer, int offset) => Read(buffer, offset);
+
+            protected override int ReadValues(in Span<float> buffer, int offset) => Read(buffer, offset);
+
+            protected override int ReadValues(in Span<byte> buffer, int offset) => Read(buffer, offset);
+
+            protected override void WriteValues(in ReadOnlySpan<int> buffer, int offset) => Write(buffer, offset);
+
+            protected override void WriteValues(in ReadOnlySpan<float> buffer, int offset) => Write(buffer, offset);
+
+            protected override void WriteValues(in ReadOnlySpan<byte> buffer, int offset) => Write(buffer, offset);
+
+            private void Write<T>(T value) where T : unmanaged
+            {
+                *(T*) _state->Values = value;
+                _state->Writes++;
+            }
+
+            private int Read<T>(in Span<T> buffer, int offset) where T : unmanaged
+            {
+                // Like the X-Plane datarefs, a null buffer asks for the length.
+                var length = _state->Length;
+                fixed (T* values = buffer)
+                {
+                    if (values == null)
+                        return length;
+                }
+                if (offset < 0 || offset >= length)
+                    return 0;
+
+                var count = Math.Min(buffer.Length, length - offset);
+                new ReadOnlySpan<T>((T*) _state->Values + offset, count).CopyTo(buffer);
+                return count;
+            }
+
+            private void Write<T>(in ReadOnlySpan<T> buffer, int offset) where T : unmanaged
+            {
+                var length = _state->Length;
+                if (buffer.IsEmpty || offset < 0 || offset >= length)
+                    return;
+
+                buffer.Slice(0, Math.Min(buffer.Length, length - offset)).CopyTo(new Span<T>((T*) _state->Values + offset, length - offset));
+                _state->Writes++;
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Text;
+using XP.SDK.XPLM.Internal;
+
+namespace XP.SDK.XPLM
+{
+    /// <summary>
+    /// The name of a dataref with its precomputed hash, which <see cref="DataRef.Find(in DataRefName)"/> looks up
+    /// in the dataref cache without hashing or converting the name.
+    /// </summary>
+    /// <remarks>
+    /// <para>
+    /// Keep the names in static fields, so that each of them is hashed once. The host interns the handles found by the plugin,
+    /// and has the hashes of the standard X-Plane datarefs built in, so that a lookup is a single probe of a hash table
+    /// after the first one. The table belongs to the plugin and is cleared when the plugin is stopped.
+    /// </para>
+    /// <para>
+    /// The hash is the 64 bit FNV-1a hash of the UTF-8 name, which must match <c>hash_dataref_name</c> of xphost.
+    /// With a host which does not cache the datarefs, the found handles are cached by the SDK.
+    /// </para>
+    /// </remarks>
+    public readonly struct DataRefName
+    {
+        private const ulong OffsetBasis = 14695981039346656037;
+        private const ulong Prime = 1099511628211;
+
+        // The handles stay valid once found, so only the names which have been found are cached.
+        // The name is kept with the handle, so that a name whose hash collides with a cached one is not given its handle.
+        private static readonly Dictionary<ulong, (string Name, DataRef DataRef)> _found = new Dictionary<ulong, (string, DataRef)>();
+
+        private readonly byte[] _utf8;
+
+        public DataRefName(string name)
+        {
+            Name = name ?? throw new ArgumentNullException(nameof(name));
+            _utf8 = new byte[Encoding.UTF8.GetByteCount(name) + 1];
+            Encoding.UTF8.GetBytes(name, 0, name.Length, _utf8, 0);
+            Hash = ComputeHash(_utf8.AsSpan(0, _utf8.Length - 1));
+        }
+
+        public string Name { get; }
+
+        public ulong Hash { get; }
+
+        /// <summary>
+        /// Computes the 64 bit FNV-1a hash of the UTF-8 name of a dataref.
+        /// </summary>
+        public static ulong ComputeHash(in ReadOnlySpan<byte> utf8Name)
+        {
+            var hash = OffsetBasis;
+            foreach (var b in utf8Name)
+            {
+                hash = (hash ^ b) * Prime;
+            }
+            return hash;
+        }
+
+        internal unsafe DataRef Find()
+        {
+            if (_utf8 == null)
+                return default;
+
+            fixed (byte* name = _utf8)
+            {
+                if (HostAPI.IsDataRefCacheSupported)
+                    return HostAPI.FindCachedDataRef(Hash, name);
+
+                if (_found.TryGetValue(Hash, out var found) && found.Name == Name)
+                    return found.DataRef;
+
+                var dataRef = DataAccessAPI.FindDataRef(name);
+                if (dataRef != default && found.Name == null)
+                {
+                    _found[Hash] = (Name, dataRef);
+                }
+                return dataRef;
+            }
+        }
+
+        public override string ToString() => Name;
+    }
+}
@@ -0,0 +1,171 @@
+﻿using System;
+using System.Runtime.CompilerServices;
+using XP.SDK.XPLM.Internal;
+
+namespace XP.SDK.XPLM
+{
+    /// <summary>
+    /// Queues dataref writes, which the host applies in one pass at the start of each flight loop phase.
+    /// </summary>
+    /// <remarks>
+    /// <para>
+    /// A queued write only stores a record, without a transition to the native code. When the queue is flushed,
+    /// only the last write of each value is applied, the writes to the consecutive elements of an array are applied
+    /// with a single call, and the writes to different datarefs may be applied in any order.
+    /// The writes queued by the flight loops before the flight model are applied after it, and those queued after the flight model
+    /// are applied before the next one. Call <see cref="Flush"/> to apply the writes earlier.
+    /// </para>
+    /// <para>
+    /// With a host which does not support the batch writes, the values are written immediately.
+    /// </para>
+    /// </remarks>
+    public static unsafe class DataRefWriteQueue
+    {
+        private static readonly DataRefWriteQueueState* _queue = HostAPI.IsDataRefWriteQueueSupported ? HostAPI.GetDataRefWriteQueue() : null;
+
+        /// <summary>
+        /// Gets the value indicating whether the writes are queued, rather than written immediately.
+        /// </summary>
+        public static bool IsQueued => _queue != null;
+
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static void Write(DataRef dataRef, int value)
+        {
+            var write = Append();
+            if (write == null)
+            {
+                DataAccessAPI.SetDatai(dataRef, value);
+                return;
+            }
+
+            write->Ref = dataRef;
+            write->Type = DataTypeID.Int;
+            write->Offset = 0;
+            write->IntValue = value;
+        }
+
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static void Write(DataRef dataRef, float value)
+        {
+            var write = Append();
+            if (write == null)
+            {
+                DataAccessAPI.SetDataf(dataRef, value);
+                return;
+            }
+
+            write->Ref = dataRef;
+            write->Type = DataTypeID.Float;
+            write->Offset = 0;
+            write->FloatValue = value;
+        }
+
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static void Write(DataRef dataRef, double value)
+        {
+            var write = Append();
+            if (write == null)
+            {
+                DataAccessAPI.SetDatad(dataRef, value);
+                return;
+            }
+
+            write->Ref = dataRef;
+            write->Type = DataTypeID.Double;
+            write->Offset = 0;
+            write->DoubleValue = value;
+        }
+
+        /// <summary>
+        /// Writes the element at the <paramref name="offset"/> of an int array.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static void WriteElement(DataRef dataRef, int offset, int value)
+        {
+            var write = Append();
+            if (write == null)
+            {
+                DataAccessAPI.SetDatavi(dataRef, &value, offset, 1);
+                return;
+            }
+
+            write->Ref = dataRef;
+            write->Type = DataTypeID.IntArray;
+            write->Offset = offset;
+            write->IntValue = value;
+        }
+
+        /// <summary>
+        /// Writes the element at the <paramref name="offset"/> of a float array.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static void WriteElement(DataRef dataRef, int offset, float value)
+        {
+            var write = Append();
+            if (write == null)
+            {
+                DataAccessAPI.SetDatavf(dataRef, &value, offset, 1);
+                return;
+            }
+
+            write->Ref = dataRef;
+            write->Type = DataTypeID.FloatArray;
+            write->Offset = offset;
+            write->FloatValue = value;
+        }
+
+        /// <summary>
+        /// Writes the elements of an int array starting at the <paramref name="offset"/>.
+        /// </summary>
+        public static void WriteValues(DataRef dataRef, in ReadOnlySpan<int> values, int offset)
+        {
+            for (int i = 0; i < values.Length; i++)
+            {
+                WriteElement(dataRef, offset + i, values[i]);
+            }
+        }
+
+        /// <summary>
+        /// Writes the elements of a float array starting at the <paramref name="offset"/>.
+        /// </summary>
+        public static void WriteValues(DataRef dataRef, in ReadOnlySpan<float> values, int offset)
+        {
+            for (int i = 0; i < values.Length; i++)
+            {
+                WriteElement(dataRef, offset + i, values[i]);
+            }
+        }
+
+        /// <summary>
+        /// Applies the queued writes now.
+        /// </summary>
+        public static void Flush()
+        {
+            if (_queue != null)
+            {
+                HostAPI.FlushDataRefWrites();
+            }
+        }
+
+        /// <summary>
+        /// Returns the record of a new write, or <see langword="null"/> if the value must be written immediately.
+        /// </summary>
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        private static DataRefWrite* Append()
+        {
+            var queue = _queue;
+            if (queue == null)
+                return null;
+
+            if (queue->Count == queue->Capacity)
+            {
+                // The queue is not flushed if a flush is in progress, e.g. when a setter queues the writes.
+                HostAPI.FlushDataRefWrites();
+                if (queue->Count == queue->Capacity)
+                    return null;
+            }
+
+            return queue->Records + queue->Count++;
+        }
+    }
+}
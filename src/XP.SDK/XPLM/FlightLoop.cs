@@ -16,18 +16,47 @@ namespace XP.SDK.XPLM
         private volatile int _disposed;
         private FlightLoopID _id;
         private GCHandle _handle;
+        private readonly CallbackProfile _profile;
+        private bool _deferred;
 
         static unsafe FlightLoop()
         {
             _flightLoopCallback = FlightLoopCallback;
 
-            static float FlightLoopCallback(float inelapsedsincelastcall, float inelapsedtimesincelastflightloop, int incounter, void* inrefcon) =>
-                Utils.TryGetObject<FlightLoop>(inrefcon)?.OnFlightLoopCallback(
-                    inelapsedsincelastcall, inelapsedtimesincelastflightloop, incounter) ?? 0;
+            static float FlightLoopCallback(float inelapsedsincelastcall, float inelapsedtimesincelastflightloop, int incounter, void* inrefcon)
+            {
+                var flightLoop = Utils.TryGetObject<FlightLoop>(inrefcon);
+                if (flightLoop == null)
+                    return 0;
+
+                // A deferrable flight loop is skipped for one frame after it has made the frame exceed the budget,
+                // as its slowest callback, but never for two frames in a row.
+                if (flightLoop.IsDeferrable && !flightLoop._deferred && flightLoop._profile.IsOverBudget)
+                {
+                    flightLoop._deferred = true;
+                    return -1;
+                }
+
+                flightLoop._deferred = false;
+                var timestamp = flightLoop._profile.Begin();
+                try
+                {
+                    return flightLoop.OnFlightLoopCallback(inelapsedsincelastcall, inelapsedtimesincelastflightloop, incounter);
+                }
+                finally
+                {
+                    flightLoop._profile.End(timestamp);
+                }
+            }
         }
 
-        protected unsafe FlightLoop(FlightLoopPhaseType phase)
+        protected FlightLoop(FlightLoopPhaseType phase) : this(phase, null)
         {
+        }
+
+        private protected unsafe FlightLoop(FlightLoopPhaseType phase, string? profileName)
+        {
+            _profile = CallbackProfile.Register("flight_loop", profileName ?? GetType().FullName!);
             _handle = GCHandle.Alloc(this);
             var parameters = new CreateFlightLoop
             {
@@ -53,6 +82,12 @@ namespace XP.SDK.XPLM
 
         public FlightLoopID Id => _id;
 
+        /// <summary>
+        /// Gets or sets the value indicating whether the flight loop may be postponed to the next frame
+        /// when the managed callbacks have exceeded the frame budget configured in xphost.
+        /// </summary>
+        public bool IsDeferrable { get; set; }
+
         public void Schedule(float interval, bool relativeToNow)
         {
             if (_disposed == 0)
@@ -89,7 +124,8 @@ namespace XP.SDK.XPLM
         {
             private readonly Callback _callback;
 
-            public CallbackFlightLoop(FlightLoopPhaseType phase, Callback callback) : base(phase)
+            public CallbackFlightLoop(FlightLoopPhaseType phase, Callback callback)
+                : base(phase, callback.Method.DeclaringType?.FullName + "." + callback.Method.Name)
             {
                 _callback = callback;
             }
@@ -44,6 +44,10 @@ namespace XP.SDK.XPLM
             }
         }
 
+        internal InstanceRef Ref => _instanceRef;
+
+        internal int DataRefCount => _dataRefCount;
+
         public unsafe void SetPosition(ref DrawInfo newPosition, in ReadOnlySpan<float> data)
         {
             if (data.Length != _dataRefCount)
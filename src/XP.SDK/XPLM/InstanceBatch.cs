@@ -0,0 +1,146 @@
+﻿using System;
+using XP.SDK.XPLM.Internal;
+
+namespace XP.SDK.XPLM
+{
+    /// <summary>
+    /// Collects the positions and the dataref values of many instances, and sets them all at once with <see cref="Apply"/>.
+    /// </summary>
+    /// <remarks>
+    /// With a host which supports the batch updates, <see cref="Apply"/> is a single native call, whatever the number of instances.
+    /// Otherwise it falls back to an <see cref="InstanceAPI.InstanceSetPosition"/> call per instance.
+    /// An instance must be removed from the batch with <see cref="Remove"/> or <see cref="Clear"/> before it is disposed.
+    /// </remarks>
+    public sealed class InstanceBatch
+    {
+        private InstanceRef[] _instances;
+        private DrawInfo[] _positions;
+        private int[] _dataOffsets;
+        private int[] _dataCounts;
+        private float[] _data;
+        private int _dataLength;
+
+        public InstanceBatch(int capacity = 64)
+        {
+            if (capacity <= 0)
+                throw new ArgumentOutOfRangeException(nameof(capacity));
+
+            _instances = new InstanceRef[capacity];
+            _positions = new DrawInfo[capacity];
+            _dataOffsets = new int[capacity];
+            _dataCounts = new int[capacity];
+            _data = new float[capacity];
+        }
+
+        public int Count { get; private set; }
+
+        /// <summary>
+        /// Adds the instance to the batch and returns its index, which the positions are set by.
+        /// </summary>
+        public unsafe int Add(Instance instance)
+        {
+            if (instance == null)
+                throw new ArgumentNullException(nameof(instance));
+
+            if (Count == _instances.Length)
+            {
+                var capacity = Count * 2;
+                Array.Resize(ref _instances, capacity);
+                Array.Resize(ref _positions, capacity);
+                Array.Resize(ref _dataOffsets, capacity);
+                Array.Resize(ref _dataCounts, capacity);
+            }
+
+            if (_dataLength + instance.DataRefCount > _data.Length)
+            {
+                Array.Resize(ref _data, Math.Max(_data.Length * 2, _dataLength + instance.DataRefCount));
+            }
+
+            var index = Count++;
+            _instances[index] = instance.Ref;
+            _positions[index] = new DrawInfo { structSize = sizeof(DrawInfo) };
+            _dataOffsets[index] = _dataLength;
+            _dataCounts[index] = instance.DataRefCount;
+            _dataLength += instance.DataRefCount;
+            return index;
+        }
+
+        /// <summary>
+        /// Removes the instance at the index from the batch. The indices of the other instances do not change,
+        /// and the index is not reused until the batch is cleared.
+        /// </summary>
+        public void Remove(int index)
+        {
+            _instances[CheckIndex(index)] = default;
+        }
+
+        /// <summary>
+        /// Removes all the instances from the batch.
+        /// </summary>
+        public void Clear()
+        {
+            Array.Clear(_instances, 0, Count);
+            Count = 0;
+            _dataLength = 0;
+        }
+
+        /// <summary>
+        /// Gets the dataref values of the instance at the index, which are set by the next <see cref="Apply"/>.
+        /// </summary>
+        public Span<float> GetData(int index) => new Span<float>(_data, _dataOffsets[CheckIndex(index)], _dataCounts[index]);
+
+        public void SetPosition(int index, in DrawInfo newPosition, in ReadOnlySpan<float> data)
+        {
+            CheckIndex(index);
+            if (data.Length != _dataCounts[index])
+                throw new ArgumentException($"Invalid length of data: {_dataCounts[index]} items were expected.", nameof(data));
+
+            _positions[index] = newPosition;
+            data.CopyTo(new Span<float>(_data, _dataOffsets[index], data.Length));
+        }
+
+        public unsafe void SetPosition(int index, float x, float y, float z, float pitch, float heading, float roll, in ReadOnlySpan<float> data)
+        {
+            var newPosition = new DrawInfo
+            {
+                structSize = sizeof(DrawInfo),
+                x = x,
+                y = y,
+                z = z,
+                pitch = pitch,
+                heading = heading,
+                roll = roll,
+            };
+            SetPosition(index, newPosition, data);
+        }
+
+        private int CheckIndex(int index) => (uint) index < (uint) Count ? index : throw new ArgumentOutOfRangeException(nameof(index));
+
+        /// <summary>
+        /// Sets the positions and the dataref values of all the instances in the batch.
+        /// Like <see cref="Instance.SetPosition(ref DrawInfo, in ReadOnlySpan{float})"/>, it must not be called from a drawing callback.
+        /// </summary>
+        public unsafe void Apply()
+        {
+            fixed (InstanceRef* pInstances = _instances)
+            fixed (DrawInfo* pPositions = _positions)
+            fixed (float* pData = _data)
+            fixed (int* pDataOffsets = _dataOffsets)
+            {
+                if (HostAPI.IsInstanceBatchSupported)
+                {
+                    HostAPI.SetInstancePositions(pInstances, Count, pPositions, pData, pDataOffsets);
+                    return;
+                }
+
+                for (int i = 0; i < Count; i++)
+                {
+                    if (pInstances[i] != default)
+                    {
+                        InstanceAPI.InstanceSetPosition(pInstances[i], pPositions + i, pData + pDataOffsets[i]);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,24 @@
+﻿namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>dataref_cell</c> structure of xphost, the value of a dataref published by the plugin and kept in native memory.
+    /// </summary>
+    /// <remarks>
+    /// The accessors registered by the host read and write <see cref="Values"/> directly: a single int, float or double,
+    /// or <see cref="Capacity"/> array elements or bytes, of which the first <see cref="Length"/> are published.
+    /// </remarks>
+    public unsafe struct DataRefCellState
+    {
+        public DataRef DataRef;
+        public DataTypeID Type;
+        public int Capacity;
+        public int Length;
+
+        /// <summary>
+        /// The number of the writes made through the dataref by the other plugins or X-Plane.
+        /// </summary>
+        public long Writes;
+
+        public void* Values;
+    }
+}
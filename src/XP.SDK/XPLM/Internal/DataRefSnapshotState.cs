@@ -0,0 +1,36 @@
+﻿namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>dataref_snapshot</c> structure of xphost, the values of a set of datarefs read into one buffer at the start of every frame.
+    /// </summary>
+    /// <remarks>
+    /// The values of the dataref i start at <c>Values + Offsets[i]</c>. Every dataref starts on a 4 byte boundary,
+    /// and the doubles on an 8 byte boundary. The buffer is 32 byte aligned, and <see cref="Size"/> is a multiple of 32 bytes.
+    /// Every read also finds the datarefs whose values differ from the previous read, bit for bit.
+    /// The first read reports all the datarefs as changed.
+    /// </remarks>
+    public unsafe struct DataRefSnapshotState
+    {
+        public int Count;
+        public int Size;
+        public int* Offsets;
+        public byte* Values;
+
+        /// <summary>
+        /// The number of times the values have been read.
+        /// </summary>
+        public long Reads;
+
+        /// <summary>
+        /// The datarefs changed by the last read, a bit per dataref.
+        /// </summary>
+        public uint* ChangedBits;
+
+        /// <summary>
+        /// The indices of the datarefs changed by the last read, in ascending order.
+        /// </summary>
+        public int* Changed;
+
+        public int ChangedCount;
+    }
+}
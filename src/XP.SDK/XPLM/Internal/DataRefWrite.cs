@@ -0,0 +1,30 @@
+﻿using System.Runtime.InteropServices;
+
+namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>dataref_write</c> structure of xphost, a queued write of a single value:
+    /// an int, float or double, or the element at <see cref="Offset"/> of an int or float array.
+    /// </summary>
+    [StructLayout(LayoutKind.Explicit, Size = 24)]
+    public struct DataRefWrite
+    {
+        [FieldOffset(0)]
+        public DataRef Ref;
+
+        [FieldOffset(8)]
+        public DataTypeID Type;
+
+        [FieldOffset(12)]
+        public int Offset;
+
+        [FieldOffset(16)]
+        public int IntValue;
+
+        [FieldOffset(16)]
+        public float FloatValue;
+
+        [FieldOffset(16)]
+        public double DoubleValue;
+    }
+}
@@ -0,0 +1,23 @@
+﻿namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>dataref_write_queue</c> structure of xphost, the dataref writes queued by the managed code.
+    /// The managed code appends the records and increments <see cref="Count"/>, and flushes the queue when it is full.
+    /// </summary>
+    public unsafe struct DataRefWriteQueueState
+    {
+        public int Capacity;
+        public int Count;
+        public DataRefWrite* Records;
+
+        /// <summary>
+        /// The number of the writes flushed since the start.
+        /// </summary>
+        public long Writes;
+
+        /// <summary>
+        /// The number of the XPLMSetData calls made for the flushed writes.
+        /// </summary>
+        public long Calls;
+    }
+}
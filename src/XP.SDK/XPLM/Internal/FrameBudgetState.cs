@@ -0,0 +1,41 @@
+﻿using System.Runtime.CompilerServices;
+
+namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>frame_budget_state</c> structure of xphost, which holds the time spent in the managed callbacks during the current frame.
+    /// </summary>
+    public struct FrameBudgetState
+    {
+        public long BudgetNanoseconds;
+        public long FrameNanoseconds;
+        public long SlowestNanoseconds;
+        public int SlowestSite;
+
+        /// <summary>
+        /// Non-zero if the previous frame has exceeded the budget.
+        /// </summary>
+        public int OverBudget;
+
+        /// <summary>
+        /// Non-zero if the deferrable flight loops should be skipped for a frame after the budget has been exceeded.
+        /// </summary>
+        public int DeferEnabled;
+
+        /// <summary>
+        /// The slowest callback of the previous frame if that frame has exceeded the budget, and -1 otherwise.
+        /// </summary>
+        public int DeferredSite;
+
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public void Record(int site, long nanoseconds)
+        {
+            FrameNanoseconds += nanoseconds;
+            if (nanoseconds > SlowestNanoseconds)
+            {
+                SlowestNanoseconds = nanoseconds;
+                SlowestSite = site;
+            }
+        }
+    }
+}
@@ -0,0 +1,36 @@
+﻿namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>gc_counters</c> structure of xphost.
+    /// </summary>
+    public unsafe struct GCCounters
+    {
+        public const int Generations = 3;
+
+        public fixed long Collections[Generations];
+        public long PauseCount;
+        public long PauseTotalNanoseconds;
+        public long PauseMaxNanoseconds;
+    }
+
+    /// <summary>
+    /// Mirrors the <c>gc_telemetry_state</c> structure of xphost, which holds the garbage collection counters.
+    /// </summary>
+    public struct GCTelemetryState
+    {
+        /// <summary>
+        /// The counters since the telemetry has been enabled. They are written by the runtime event dispatch thread.
+        /// </summary>
+        public GCCounters Total;
+
+        /// <summary>
+        /// The counters of the last completed frame, written by xphost.
+        /// </summary>
+        public GCCounters LastFrame;
+
+        /// <summary>
+        /// The longest pause since the start of the current frame, reset by xphost at the end of the frame.
+        /// </summary>
+        public long FramePauseMaxNanoseconds;
+    }
+}
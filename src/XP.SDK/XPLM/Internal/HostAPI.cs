@@ -0,0 +1,495 @@
+﻿using System;
+using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using InlineIL;
+
+namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Native services provided by xphost, the native host of the managed plugins.
+    /// </summary>
+    public static class HostAPI
+    {
+        private static IntPtr BeginPhasePtr;
+        private static IntPtr EndPhasePtr;
+        private static IntPtr RegisterProfileSlotPtr;
+        private static IntPtr GetFrameBudgetPtr;
+        private static IntPtr RegisterBudgetSitePtr;
+        private static IntPtr GetGCTelemetryPtr;
+        private static IntPtr ReadNavAidRangePtr;
+        private static IntPtr ReadNavAidListPtr;
+        private static IntPtr ProbeTerrainBatchPtr;
+        private static IntPtr SetInstancePositionsPtr;
+        private static IntPtr CreateDataRefSnapshotPtr;
+        private static IntPtr DestroyDataRefSnapshotPtr;
+        private static IntPtr ReadDataRefSnapshotPtr;
+        private static IntPtr GetDataRefWriteQueuePtr;
+        private static IntPtr FlushDataRefWritesPtr;
+        private static IntPtr CreateDataRefCellPtr;
+        private static IntPtr DestroyDataRefCellPtr;
+        private static IntPtr FindCachedDataRefPtr;
+
+        /// <summary>
+        /// Mirrors the <c>host_api</c> table of xphost. New functions must be appended to the end of the structure.
+        /// </summary>
+        private struct HostApiTable
+        {
+            public int Size;
+            public IntPtr BeginPhase;
+            public IntPtr EndPhase;
+            public IntPtr RegisterProfileSlot;
+            public IntPtr GetFrameBudget;
+            public IntPtr RegisterBudgetSite;
+            public IntPtr GetGCTelemetry;
+            public IntPtr ReadNavAidRange;
+            public IntPtr ReadNavAidList;
+            public IntPtr ProbeTerrainBatch;
+            public IntPtr SetInstancePositions;
+            public IntPtr CreateDataRefSnapshot;
+            public IntPtr DestroyDataRefSnapshot;
+            public IntPtr ReadDataRefSnapshot;
+            public IntPtr GetDataRefWriteQueue;
+            public IntPtr FlushDataRefWrites;
+            public IntPtr CreateDataRefCell;
+            public IntPtr DestroyDataRefCell;
+            public IntPtr FindCachedDataRef;
+        }
+
+        internal static unsafe void Initialize(IntPtr table)
+        {
+            if (table == IntPtr.Zero)
+                return;
+
+            var api = (HostApiTable*) table;
+            BeginPhasePtr = GetFunction(api, nameof(HostApiTable.BeginPhase));
+            EndPhasePtr = GetFunction(api, nameof(HostApiTable.EndPhase));
+            RegisterProfileSlotPtr = GetFunction(api, nameof(HostApiTable.RegisterProfileSlot));
+            GetFrameBudgetPtr = GetFunction(api, nameof(HostApiTable.GetFrameBudget));
+            RegisterBudgetSitePtr = GetFunction(api, nameof(HostApiTable.RegisterBudgetSite));
+            GetGCTelemetryPtr = GetFunction(api, nameof(HostApiTable.GetGCTelemetry));
+            ReadNavAidRangePtr = GetFunction(api, nameof(HostApiTable.ReadNavAidRange));
+            ReadNavAidListPtr = GetFunction(api, nameof(HostApiTable.ReadNavAidList));
+            ProbeTerrainBatchPtr = GetFunction(api, nameof(HostApiTable.ProbeTerrainBatch));
+            SetInstancePositionsPtr = GetFunction(api, nameof(HostApiTable.SetInstancePositions));
+            CreateDataRefSnapshotPtr = GetFunction(api, nameof(HostApiTable.CreateDataRefSnapshot));
+            DestroyDataRefSnapshotPtr = GetFunction(api, nameof(HostApiTable.DestroyDataRefSnapshot));
+            ReadDataRefSnapshotPtr = GetFunction(api, nameof(HostApiTable.ReadDataRefSnapshot));
+            GetDataRefWriteQueuePtr = GetFunction(api, nameof(HostApiTable.GetDataRefWriteQueue));
+            FlushDataRefWritesPtr = GetFunction(api, nameof(HostApiTable.FlushDataRefWrites));
+            CreateDataRefCellPtr = GetFunction(api, nameof(HostApiTable.CreateDataRefCell));
+            DestroyDataRefCellPtr = GetFunction(api, nameof(HostApiTable.DestroyDataRefCell));
+            FindCachedDataRefPtr = GetFunction(api, nameof(HostApiTable.FindCachedDataRef));
+        }
+
+        private static unsafe IntPtr GetFunction(HostApiTable* api, string name)
+        {
+            // The host may be older than the SDK, in which case the table does not contain the function.
+            var offset = (int) Marshal.OffsetOf<HostApiTable>(name);
+            return api->Size >= offset + IntPtr.Size ? Marshal.ReadIntPtr((IntPtr) api, offset) : IntPtr.Zero;
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host records the startup trace.
+        /// </summary>
+        public static bool IsTracingSupported => BeginPhasePtr != IntPtr.Zero && EndPhasePtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Starts a startup trace phase. The phases are nested and must be ended with <see cref="EndPhase"/>.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void BeginPhase(byte* inName)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(BeginPhasePtr);
+            IL.Push(inName);
+            IL.Push(BeginPhasePtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void), typeof(byte*)));
+        }
+
+        /// <summary>
+        /// Starts a startup trace phase. The phases are nested and must be ended with <see cref="EndPhase"/>.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void BeginPhase(in ReadOnlySpan<char> inName)
+        {
+            IL.DeclareLocals(false);
+            Span<byte> inNameUtf8 = stackalloc byte[(inName.Length << 1) | 1];
+            var inNamePtr = Utils.ToUtf8Unsafe(inName, inNameUtf8);
+            BeginPhase(inNamePtr);
+        }
+
+        /// <summary>
+        /// Ends the innermost startup trace phase.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void EndPhase()
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(EndPhasePtr);
+            IL.Push(EndPhasePtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void)));
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the callback profiling.
+        /// </summary>
+        public static bool IsProfilingSupported => RegisterProfileSlotPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Gets the profiling counters for the callback registration.
+        /// Returns <see langword="null"/> if the callback profiling is disabled.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe ProfileSlot* RegisterProfileSlot(byte* inKind, byte* inName)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(RegisterProfileSlotPtr);
+            void* result;
+            IL.Push(inKind);
+            IL.Push(inName);
+            IL.Push(RegisterProfileSlotPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void*), typeof(byte*), typeof(byte*)));
+            IL.Pop(out result);
+            return (ProfileSlot*) result;
+        }
+
+        /// <summary>
+        /// Gets the profiling counters for the callback registration.
+        /// Returns <see langword="null"/> if the callback profiling is disabled.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe ProfileSlot* RegisterProfileSlot(in ReadOnlySpan<char> inKind, in ReadOnlySpan<char> inName)
+        {
+            IL.DeclareLocals(false);
+            Span<byte> inKindUtf8 = stackalloc byte[(inKind.Length << 1) | 1];
+            var inKindPtr = Utils.ToUtf8Unsafe(inKind, inKindUtf8);
+            Span<byte> inNameUtf8 = stackalloc byte[(inName.Length << 1) | 1];
+            var inNamePtr = Utils.ToUtf8Unsafe(inName, inNameUtf8);
+            return RegisterProfileSlot(inKindPtr, inNamePtr);
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the frame budget watchdog.
+        /// </summary>
+        public static bool IsFrameBudgetSupported => GetFrameBudgetPtr != IntPtr.Zero && RegisterBudgetSitePtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Gets the time spent in the managed callbacks during the current frame.
+        /// Returns <see langword="null"/> if the frame budget watchdog is disabled.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe FrameBudgetState* GetFrameBudget()
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(GetFrameBudgetPtr);
+            void* result;
+            IL.Push(GetFrameBudgetPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void*)));
+            IL.Pop(out result);
+            return (FrameBudgetState*) result;
+        }
+
+        /// <summary>
+        /// Gets the identifier of the callback registration, which is reported when the callback exceeds the frame budget.
+        /// Returns -1 if the frame budget watchdog is disabled.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe int RegisterBudgetSite(byte* inKind, byte* inName)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(RegisterBudgetSitePtr);
+            int result;
+            IL.Push(inKind);
+            IL.Push(inName);
+            IL.Push(RegisterBudgetSitePtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(int), typeof(byte*), typeof(byte*)));
+            IL.Pop(out result);
+            return result;
+        }
+
+        /// <summary>
+        /// Gets the identifier of the callback registration, which is reported when the callback exceeds the frame budget.
+        /// Returns -1 if the frame budget watchdog is disabled.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe int RegisterBudgetSite(in ReadOnlySpan<char> inKind, in ReadOnlySpan<char> inName)
+        {
+            IL.DeclareLocals(false);
+            Span<byte> inKindUtf8 = stackalloc byte[(inKind.Length << 1) | 1];
+            var inKindPtr = Utils.ToUtf8Unsafe(inKind, inKindUtf8);
+            Span<byte> inNameUtf8 = stackalloc byte[(inName.Length << 1) | 1];
+            var inNamePtr = Utils.ToUtf8Unsafe(inName, inNameUtf8);
+            return RegisterBudgetSite(inKindPtr, inNamePtr);
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the GC telemetry.
+        /// </summary>
+        public static bool IsGCTelemetrySupported => GetGCTelemetryPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Gets the garbage collection counters reported by the host.
+        /// Returns <see langword="null"/> if the GC telemetry is disabled.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe GCTelemetryState* GetGCTelemetry()
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(GetGCTelemetryPtr);
+            void* result;
+            IL.Push(GetGCTelemetryPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void*)));
+            IL.Pop(out result);
+            return (GCTelemetryState*) result;
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the batch navaid queries.
+        /// </summary>
+        public static bool IsNavAidBatchSupported => ReadNavAidRangePtr != IntPtr.Zero && ReadNavAidListPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Reads the navaids starting at <paramref name="inFirst"/>, in the order of <see cref="NavigationAPI.GetNextNavAid"/>,
+        /// until the columns are full or the database ends. Returns the number of the navaids read.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe int ReadNavAidRange(NavRef inFirst, NavAidColumns* inColumns)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(ReadNavAidRangePtr);
+            int result;
+            IL.Push(inFirst);
+            IL.Push(inColumns);
+            IL.Push(ReadNavAidRangePtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(int), typeof(NavRef), typeof(NavAidColumns*)));
+            IL.Pop(out result);
+            return result;
+        }
+
+        /// <summary>
+        /// Reads the given navaids, at most as many as the columns can hold. Returns the number of the navaids read.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe int ReadNavAidList(NavRef* inRefs, int inCount, NavAidColumns* inColumns)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(ReadNavAidListPtr);
+            int result;
+            IL.Push(inRefs);
+            IL.Push(inCount);
+            IL.Push(inColumns);
+            IL.Push(ReadNavAidListPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(int), typeof(NavRef*), typeof(int), typeof(NavAidColumns*)));
+            IL.Pop(out result);
+            return result;
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the batch terrain probes.
+        /// </summary>
+        public static bool IsProbeBatchSupported => ProbeTerrainBatchPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Probes the terrain under <paramref name="inCount"/> points, given as x, y, z triples in the local coordinates.
+        /// The <see cref="ProbeInfo.structSize"/> of every info must be set. Returns the number of the points which hit the terrain.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe int ProbeTerrainBatch(ProbeRef inProbe, float* inPoints, int inCount, ProbeInfo* outInfos, ProbeResult* outResults)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(ProbeTerrainBatchPtr);
+            int result;
+            IL.Push(inProbe);
+            IL.Push(inPoints);
+            IL.Push(inCount);
+            IL.Push(outInfos);
+            IL.Push(outResults);
+            IL.Push(ProbeTerrainBatchPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(int), typeof(ProbeRef), typeof(float*), typeof(int), typeof(ProbeInfo*), typeof(ProbeResult*)));
+            IL.Pop(out result);
+            return result;
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the batch instance updates.
+        /// </summary>
+        public static bool IsInstanceBatchSupported => SetInstancePositionsPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Sets the positions and the dataref values of <paramref name="inCount"/> instances.
+        /// The dataref values of the instance i start at <c>inData + inDataOffsets[i]</c>.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void SetInstancePositions(InstanceRef* inInstances, int inCount, DrawInfo* inPositions, float* inData, int* inDataOffsets)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(SetInstancePositionsPtr);
+            IL.Push(inInstances);
+            IL.Push(inCount);
+            IL.Push(inPositions);
+            IL.Push(inData);
+            IL.Push(inDataOffsets);
+            IL.Push(SetInstancePositionsPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void), typeof(InstanceRef*), typeof(int), typeof(DrawInfo*), typeof(float*), typeof(int*)));
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the per-frame dataref snapshots.
+        /// </summary>
+        public static bool IsDataRefSnapshotSupported =>
+            CreateDataRefSnapshotPtr != IntPtr.Zero && DestroyDataRefSnapshotPtr != IntPtr.Zero && ReadDataRefSnapshotPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Creates a snapshot of <paramref name="inCount"/> datarefs, which the host reads at the start of every frame.
+        /// The type of each dataref must be exactly one of the <see cref="DataTypeID"/> values; <paramref name="inCounts"/> gives
+        /// the number of the array elements or bytes read from the array and data datarefs, and may be <see langword="null"/> if there are none.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe DataRefSnapshotState* CreateDataRefSnapshot(DataRef* inRefs, DataTypeID* inTypes, int* inCounts, int inCount)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(CreateDataRefSnapshotPtr);
+            void* result;
+            IL.Push(inRefs);
+            IL.Push(inTypes);
+            IL.Push(inCounts);
+            IL.Push(inCount);
+            IL.Push(CreateDataRefSnapshotPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void*), typeof(DataRef*), typeof(DataTypeID*), typeof(int*), typeof(int)));
+            IL.Pop(out result);
+            return (DataRefSnapshotState*) result;
+        }
+
+        /// <summary>
+        /// Destroys the snapshot created by <see cref="CreateDataRefSnapshot"/>.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void DestroyDataRefSnapshot(DataRefSnapshotState* inSnapshot)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(DestroyDataRefSnapshotPtr);
+            IL.Push(inSnapshot);
+            IL.Push(DestroyDataRefSnapshotPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void), typeof(DataRefSnapshotState*)));
+        }
+
+        /// <summary>
+        /// Reads the values of the snapshot now, in addition to the read at the start of the frame.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void ReadDataRefSnapshot(DataRefSnapshotState* inSnapshot)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(ReadDataRefSnapshotPtr);
+            IL.Push(inSnapshot);
+            IL.Push(ReadDataRefSnapshotPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void), typeof(DataRefSnapshotState*)));
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the batch dataref writes.
+        /// </summary>
+        public static bool IsDataRefWriteQueueSupported => GetDataRefWriteQueuePtr != IntPtr.Zero && FlushDataRefWritesPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Gets the queue of the dataref writes, which the host flushes at the start of both flight loop phases.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe DataRefWriteQueueState* GetDataRefWriteQueue()
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(GetDataRefWriteQueuePtr);
+            void* result;
+            IL.Push(GetDataRefWriteQueuePtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void*)));
+            IL.Pop(out result);
+            return (DataRefWriteQueueState*) result;
+        }
+
+        /// <summary>
+        /// Applies the queued dataref writes now.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void FlushDataRefWrites()
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(FlushDataRefWritesPtr);
+            IL.Push(FlushDataRefWritesPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void)));
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host supports the native dataref cells.
+        /// </summary>
+        public static bool IsDataRefCellSupported => CreateDataRefCellPtr != IntPtr.Zero && DestroyDataRefCellPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Publishes a dataref whose value is kept in native memory and read by the native accessors of the host.
+        /// Returns <see langword="null"/> if the dataref cannot be registered.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe DataRefCellState* CreateDataRefCell(byte* inName, DataTypeID inType, int inCapacity, int inWritable)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(CreateDataRefCellPtr);
+            void* result;
+            IL.Push(inName);
+            IL.Push(inType);
+            IL.Push(inCapacity);
+            IL.Push(inWritable);
+            IL.Push(CreateDataRefCellPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void*), typeof(byte*), typeof(DataTypeID), typeof(int), typeof(int)));
+            IL.Pop(out result);
+            return (DataRefCellState*) result;
+        }
+
+        /// <summary>
+        /// Publishes a dataref whose value is kept in native memory and read by the native accessors of the host.
+        /// Returns <see langword="null"/> if the dataref cannot be registered.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe DataRefCellState* CreateDataRefCell(in ReadOnlySpan<char> inName, DataTypeID inType, int inCapacity, int inWritable)
+        {
+            IL.DeclareLocals(false);
+            Span<byte> inNameUtf8 = stackalloc byte[(inName.Length << 1) | 1];
+            var inNamePtr = Utils.ToUtf8Unsafe(inName, inNameUtf8);
+            return CreateDataRefCell(inNamePtr, inType, inCapacity, inWritable);
+        }
+
+        /// <summary>
+        /// Unregisters the dataref created by <see cref="CreateDataRefCell(byte*, DataTypeID, int, int)"/> and frees its value.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe void DestroyDataRefCell(DataRefCellState* inCell)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(DestroyDataRefCellPtr);
+            IL.Push(inCell);
+            IL.Push(DestroyDataRefCellPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(void), typeof(DataRefCellState*)));
+        }
+
+        /// <summary>
+        /// Gets the value indicating whether the host caches the dataref handles.
+        /// </summary>
+        public static bool IsDataRefCacheSupported => FindCachedDataRefPtr != IntPtr.Zero;
+
+        /// <summary>
+        /// Finds the dataref by the 64 bit FNV-1a hash of its UTF-8 name, which the host looks up in its cache,
+        /// and only finds by the name the first time.
+        /// </summary>
+        [MethodImplAttribute(MethodImplOptions.AggressiveInlining)]
+        public static unsafe DataRef FindCachedDataRef(ulong inHash, byte* inName)
+        {
+            IL.DeclareLocals(false);
+            Guard.NotNull(FindCachedDataRefPtr);
+            DataRef result;
+            IL.Push(inHash);
+            IL.Push(inName);
+            IL.Push(FindCachedDataRefPtr);
+            IL.Emit.Calli(new StandAloneMethodSig(CallingConvention.Cdecl, typeof(DataRef), typeof(ulong), typeof(byte*)));
+            IL.Pop(out result);
+            return result;
+        }
+    }
+}
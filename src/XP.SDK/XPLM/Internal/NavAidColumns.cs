@@ -0,0 +1,27 @@
+﻿namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>nav_aid_columns</c> structure of xphost, the struct-of-arrays buffer filled by the batch navaid queries.
+    /// </summary>
+    /// <remarks>
+    /// Every non-null column has <see cref="Capacity"/> entries. The <see cref="Ids"/> and <see cref="Names"/> columns
+    /// have <see cref="IdSize"/> and <see cref="NameSize"/> bytes per entry. The null columns are not read.
+    /// </remarks>
+    public unsafe struct NavAidColumns
+    {
+        public const int IdSize = 32;
+        public const int NameSize = 256;
+
+        public int Capacity;
+        public NavRef* Refs;
+        public NavType* Types;
+        public float* Latitudes;
+        public float* Longitudes;
+        public float* Heights;
+        public int* Frequencies;
+        public float* Headings;
+        public byte* Ids;
+        public byte* Names;
+        public byte* Regions;
+    }
+}
@@ -0,0 +1,37 @@
+﻿using System;
+using System.Numerics;
+using System.Runtime.CompilerServices;
+
+namespace XP.SDK.XPLM.Internal
+{
+    /// <summary>
+    /// Mirrors the <c>profile_slot</c> structure of xphost, which holds the timing counters of a single callback registration.
+    /// </summary>
+    public unsafe struct ProfileSlot
+    {
+        public const int HistogramBuckets = 32;
+
+        public long Count;
+        public long TotalNanoseconds;
+        public long MaxNanoseconds;
+
+        /// <summary>
+        /// Bucket <c>i</c> counts the callbacks which took [2^i, 2^(i+1)) nanoseconds.
+        /// </summary>
+        public fixed long Histogram[HistogramBuckets];
+
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public void Record(long nanoseconds)
+        {
+            Count++;
+            TotalNanoseconds += nanoseconds;
+            if (nanoseconds > MaxNanoseconds)
+            {
+                MaxNanoseconds = nanoseconds;
+            }
+
+            var bucket = nanoseconds > 0 ? BitOperations.Log2((ulong) nanoseconds) : 0;
+            Histogram[Math.Min(bucket, HistogramBuckets - 1)]++;
+        }
+    }
+}
@@ -0,0 +1,201 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using XP.SDK.XPLM.Internal;
+
+namespace XP.SDK.XPLM
+{
+    /// <summary>
+    /// Reads the properties of many navaids at once into the column arrays of the batch.
+    /// </summary>
+    /// <remarks>
+    /// With a host which supports the batch queries a read is a single native call, whatever the number of navaids.
+    /// Otherwise the batch falls back to a <see cref="NavigationAPI.GetNavAidInfo"/> call per navaid.
+    /// Only the columns of the requested <see cref="NavAidFields"/> are read; the other ones are empty.
+    /// </remarks>
+    public sealed class NavAidBatch
+    {
+        private readonly NavRef[] _navRefs;
+        private readonly NavType[] _types;
+        private readonly float[] _latitudes;
+        private readonly float[] _longitudes;
+        private readonly float[] _heights;
+        private readonly int[] _frequencies;
+        private readonly float[] _headings;
+        private readonly byte[] _ids;
+        private readonly byte[] _names;
+        private readonly byte[] _regions;
+
+        public NavAidBatch(int capacity, NavAidFields fields = NavAidFields.All)
+        {
+            if (capacity <= 0)
+                throw new ArgumentOutOfRangeException(nameof(capacity));
+
+            Capacity = capacity;
+            Fields = fields;
+            _navRefs = new NavRef[capacity];
+            _types = Allocate<NavType>(NavAidFields.Type, capacity);
+            _latitudes = Allocate<float>(NavAidFields.Coordinates, capacity);
+            _longitudes = Allocate<float>(NavAidFields.Coordinates, capacity);
+            _heights = Allocate<float>(NavAidFields.Height, capacity);
+            _frequencies = Allocate<int>(NavAidFields.Frequency, capacity);
+            _headings = Allocate<float>(NavAidFields.Heading, capacity);
+            _ids = Allocate<byte>(NavAidFields.Id, capacity * NavAidColumns.IdSize);
+            _names = Allocate<byte>(NavAidFields.Name, capacity * NavAidColumns.NameSize);
+            _regions = Allocate<byte>(NavAidFields.IsInLocalRegion, capacity);
+        }
+
+        private T[] Allocate<T>(NavAidFields field, int length) => (Fields & field) != 0 ? new T[length] : Array.Empty<T>();
+
+        public int Capacity { get; }
+
+        public NavAidFields Fields { get; }
+
+        /// <summary>
+        /// Gets the number of the navaids read by the last call of <see cref="ReadRange"/> or <see cref="Read"/>.
+        /// </summary>
+        public int Count { get; private set; }
+
+        public ReadOnlySpan<NavRef> NavRefs => new ReadOnlySpan<NavRef>(_navRefs, 0, Count);
+
+        public ReadOnlySpan<NavType> Types => Column(_types);
+
+        public ReadOnlySpan<float> Latitudes => Column(_latitudes);
+
+        public ReadOnlySpan<float> Longitudes => Column(_longitudes);
+
+        public ReadOnlySpan<float> Heights => Column(_heights);
+
+        public ReadOnlySpan<int> Frequencies => Column(_frequencies);
+
+        public ReadOnlySpan<float> Headings => Column(_headings);
+
+        private ReadOnlySpan<T> Column<T>(T[] column) => column.Length != 0 ? new ReadOnlySpan<T>(column, 0, Count) : default;
+
+        public NavAid this[int index] => new NavAid(NavRefs[index]);
+
+        public string GetId(int index) => GetString(_ids, NavAidColumns.IdSize, index);
+
+        public string GetName(int index) => GetString(_names, NavAidColumns.NameSize, index);
+
+        public bool IsInLocalRegion(int index) => _regions[CheckIndex(index)] != 0;
+
+        private int CheckIndex(int index) => (uint) index < (uint) Count ? index : throw new ArgumentOutOfRangeException(nameof(index));
+
+        private unsafe string GetString(byte[] column, int size, int index)
+        {
+            fixed (byte* pColumn = &column[CheckIndex(index) * size])
+            {
+                return Marshal.PtrToStringUTF8(new IntPtr(pColumn));
+            }
+        }
+
+        /// <summary>
+        /// Reads the navaids starting at <paramref name="first"/>, in the order of <see cref="NavigationAPI.GetNextNavAid"/>,
+        /// until the batch is full or the database ends. Returns the number of the navaids read.
+        /// </summary>
+        public unsafe int ReadRange(NavRef first)
+        {
+            fixed (NavRef* pNavRefs = _navRefs)
+            fixed (NavType* pTypes = _types)
+            fixed (float* pLatitudes = _latitudes, pLongitudes = _longitudes, pHeights = _heights, pHeadings = _headings)
+            fixed (int* pFrequencies = _frequencies)
+            fixed (byte* pIds = _ids, pNames = _names, pRegions = _regions)
+            {
+                var columns = new NavAidColumns
+                {
+                    Capacity = Capacity,
+                    Refs = pNavRefs,
+                    Types = pTypes,
+                    Latitudes = pLatitudes,
+                    Longitudes = pLongitudes,
+                    Heights = pHeights,
+                    Frequencies = pFrequencies,
+                    Headings = pHeadings,
+                    Ids = pIds,
+                    Names = pNames,
+                    Regions = pRegions
+                };
+
+                if (HostAPI.IsNavAidBatchSupported)
+                    return Count = HostAPI.ReadNavAidRange(first, &columns);
+
+                int count = 0;
+                for (var navRef = first; navRef != NavRef.NotFound && count < Capacity; navRef = NavigationAPI.GetNextNavAid(navRef))
+                {
+                    ReadOne(navRef, count++, &columns);
+                }
+                return Count = count;
+            }
+        }
+
+        /// <summary>
+        /// Reads the given navaids, at most <see cref="Capacity"/> of them. Returns the number of the navaids read.
+        /// </summary>
+        public unsafe int Read(ReadOnlySpan<NavRef> navRefs)
+        {
+            fixed (NavRef* pRefs = navRefs)
+            fixed (NavRef* pNavRefs = _navRefs)
+            fixed (NavType* pTypes = _types)
+            fixed (float* pLatitudes = _latitudes, pLongitudes = _longitudes, pHeights = _heights, pHeadings = _headings)
+            fixed (int* pFrequencies = _frequencies)
+            fixed (byte* pIds = _ids, pNames = _names, pRegions = _regions)
+            {
+                var columns = new NavAidColumns
+                {
+                    Capacity = Capacity,
+                    Refs = pNavRefs,
+                    Types = pTypes,
+                    Latitudes = pLatitudes,
+                    Longitudes = pLongitudes,
+                    Heights = pHeights,
+                    Frequencies = pFrequencies,
+                    Headings = pHeadings,
+                    Ids = pIds,
+                    Names = pNames,
+                    Regions = pRegions
+                };
+
+                if (HostAPI.IsNavAidBatchSupported)
+                    return Count = HostAPI.ReadNavAidList(pRefs, navRefs.Length, &columns);
+
+                int count = Math.Min(navRefs.Length, Capacity);
+                for (int i = 0; i < count; i++)
+                {
+                    ReadOne(navRefs[i], i, &columns);
+                }
+                return Count = count;
+            }
+        }
+
+        private static unsafe void ReadOne(NavRef navRef, int index, NavAidColumns* columns)
+        {
+            columns->Refs[index] = navRef;
+            NavigationAPI.GetNavAidInfo(navRef,
+                columns->Types != null ? columns->Types + index : null,
+                columns->Latitudes != null ? columns->Latitudes + index : null,
+                columns->Longitudes != null ? columns->Longitudes + index : null,
+                columns->Heights != null ? columns->Heights + index : null,
+                columns->Frequencies != null ? columns->Frequencies + index : null,
+                columns->Headings != null ? columns->Headings + index : null,
+                columns->Ids != null ? columns->Ids + index * NavAidColumns.IdSize : null,
+                columns->Names != null ? columns->Names + index * NavAidColumns.NameSize : null,
+                columns->Regions != null ? columns->Regions + index : null);
+        }
+
+        /// <summary>
+        /// Reads the whole navaid database, <paramref name="batchSize"/> navaids at a time.
+        /// The same batch is refilled and returned for every chunk, so it must not be kept across the iterations.
+        /// </summary>
+        public static IEnumerable<NavAidBatch> Enumerate(NavAidFields fields = NavAidFields.All, int batchSize = 16384)
+        {
+            var batch = new NavAidBatch(batchSize, fields);
+            var next = NavigationAPI.GetFirstNavAid();
+            while (next != NavRef.NotFound && batch.ReadRange(next) > 0)
+            {
+                yield return batch;
+                next = batch.Count == batch.Capacity ? NavigationAPI.GetNextNavAid(batch._navRefs[batch.Count - 1]) : NavRef.NotFound;
+            }
+        }
+    }
+}
@@ -0,0 +1,22 @@
+﻿using System;
+
+namespace XP.SDK.XPLM
+{
+    /// <summary>
+    /// The navaid properties read by <see cref="NavAidBatch"/>.
+    /// </summary>
+    [Flags]
+    public enum NavAidFields
+    {
+        None = 0,
+        Type = 1,
+        Coordinates = 2,
+        Height = 4,
+        Frequency = 8,
+        Heading = 16,
+        Id = 32,
+        Name = 64,
+        IsInLocalRegion = 128,
+        All = Type | Coordinates | Height | Frequency | Heading | Id | Name | IsInLocalRegion
+    }
+}
@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Numerics;
 using System.Runtime.CompilerServices;
 using System.Text;
 using System.Threading;
@@ -20,10 +21,43 @@ namespace XP.SDK.XPLM
         public unsafe (ProbeResult result, ProbeInfo info) ProbeTerrain(float x, float y, float z)
         {
             var info = new ProbeInfo { structSize = Unsafe.SizeOf<ProbeInfo>() };
-            var result = SceneryAPI.ProbeTerrainXYZ(_ref, x, y, x, &info);
+            var result = SceneryAPI.ProbeTerrainXYZ(_ref, x, y, z, &info);
             return (result, info);
         }
 
+        /// <summary>
+        /// Probes the terrain under each of the <paramref name="points"/>, which are in the local coordinates.
+        /// With a host which supports the batch probes, all the points are probed in a single native call.
+        /// </summary>
+        /// <returns>The number of the points which hit the terrain.</returns>
+        public unsafe int ProbeTerrain(ReadOnlySpan<Vector3> points, Span<ProbeInfo> infos, Span<ProbeResult> results)
+        {
+            if (infos.Length < points.Length || results.Length < points.Length)
+                throw new ArgumentException("The infos and the results must have an entry for each point.");
+
+            for (int i = 0; i < points.Length; i++)
+            {
+                infos[i].structSize = Unsafe.SizeOf<ProbeInfo>();
+            }
+
+            fixed (Vector3* pPoints = points)
+            fixed (ProbeInfo* pInfos = infos)
+            fixed (ProbeResult* pResults = results)
+            {
+                if (HostAPI.IsProbeBatchSupported)
+                    return HostAPI.ProbeTerrainBatch(_ref, (float*) pPoints, points.Length, pInfos, pResults);
+
+                int hits = 0;
+                for (int i = 0; i < points.Length; i++)
+                {
+                    pResults[i] = SceneryAPI.ProbeTerrainXYZ(_ref, pPoints[i].X, pPoints[i].Y, pPoints[i].Z, pInfos + i);
+                    if (pResults[i] == ProbeResult.HitTerrain)
+                        hits++;
+                }
+                return hits;
+            }
+        }
+
         /// <inheritdoc />
         public void Dispose()
         {
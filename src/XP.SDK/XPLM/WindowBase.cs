@@ -27,6 +27,7 @@ namespace XP.SDK.XPLM
         private GCHandle _handle;
         private WindowID _id;
         private string _title;
+        private readonly CallbackProfile _drawProfile;
 
         #region Constructors
 
@@ -39,8 +40,22 @@ namespace XP.SDK.XPLM
             _handleKeyCallback = HandleKey;
             _handleCursorCallback = HandleCursor;
 
-            static void DrawWindow(WindowID inwindowid, void* inrefcon) => 
-                Utils.TryGetObject<WindowBase>(inrefcon)?.OnDrawWindow();
+            static void DrawWindow(WindowID inwindowid, void* inrefcon)
+            {
+                var window = Utils.TryGetObject<WindowBase>(inrefcon);
+                if (window != null)
+                {
+                    var timestamp = window._drawProfile.Begin();
+                    try
+                    {
+                        window.OnDrawWindow();
+                    }
+                    finally
+                    {
+                        window._drawProfile.End(timestamp);
+                    }
+                }
+            }
 
             static int HandleMouseLeftClick(WindowID inwindowid, int x, int y, MouseStatus inmouse, void* inrefcon) =>
                 (Utils.TryGetObject<WindowBase>(inrefcon)?.OnMouseLeftButtonEvent(x, y, inmouse) == true).ToInt();
@@ -72,6 +87,7 @@ namespace XP.SDK.XPLM
             WindowDecoration decoration = WindowDecoration.None,
             MouseHandlers mouseHandlers = MouseHandlers.All)
         {
+            _drawProfile = CallbackProfile.Register("draw_window", GetType().FullName);
             _handle = GCHandle.Alloc(this);
             
             var parameters = new CreateWindow
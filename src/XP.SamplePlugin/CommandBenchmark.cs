@@ -0,0 +1,69 @@
+﻿using System;
+using System.Diagnostics;
+using XP.SDK;
+using XP.SDK.XPLM;
+
+namespace XP.SamplePlugin
+{
+    /// <summary>
+    /// Measures the cost of firing a command handled by managed handlers, and the bytes the managed code allocates per command,
+    /// against the command created by the sim harness (see run_command_benchmark in host/sim/main.cpp).
+    /// It runs when XP_SAMPLE_COMMAND_BENCHMARK is set to the number of iterations.
+    /// </summary>
+    internal static class CommandBenchmark
+    {
+        public static void RunIfRequested()
+        {
+            if (!int.TryParse(Environment.GetEnvironmentVariable("XP_SAMPLE_COMMAND_BENCHMARK"), out var iterations) || iterations <= 0)
+                return;
+
+            var command = Command.Find("sim/benchmark/command");
+            if (command == null)
+            {
+                XPlane.Trace.WriteLine("The benchmark command is not defined.");
+                return;
+            }
+
+            var sink = 0;
+            command.BeforeExecute += OnBeforeExecute;
+            command.AfterExecute += OnAfterExecute;
+
+            void OnBeforeExecute(Command sender, ref CommandBeforeExecuteEventArgs args) => sink++;
+            void OnAfterExecute(Command sender, in CommandAfterExecuteEventArgs args) => sink++;
+
+            // The first command runs outside of the measurement, so that the JIT and the static constructors are not counted.
+            command.Once();
+            Measure("Command.Once", iterations, () =>
+            {
+                for (var i = 0; i < iterations; i++)
+                {
+                    command.Once();
+                }
+            });
+            Measure("Command.BeginScopeAllocationFree", iterations, () =>
+            {
+                for (var i = 0; i < iterations; i++)
+                {
+                    using (command.BeginScopeAllocationFree())
+                    {
+                    }
+                }
+            });
+
+            command.BeforeExecute -= OnBeforeExecute;
+            command.AfterExecute -= OnAfterExecute;
+            GC.KeepAlive(sink);
+        }
+
+        private static void Measure(string operation, int iterations, Action action)
+        {
+            var allocated = GC.GetAllocatedBytesForCurrentThread();
+            var stopwatch = Stopwatch.StartNew();
+            action();
+            stopwatch.Stop();
+            var bytes = (double) (GC.GetAllocatedBytesForCurrentThread() - allocated) / iterations;
+            var nanoseconds = stopwatch.Elapsed.TotalMilliseconds * 1e6 / iterations;
+            XPlane.Trace.WriteLine($"{operation,-32} {nanoseconds,8:F2}ns/op {1e3 / nanoseconds,10:F2}Mops/s {bytes,8:F2}B/op");
+        }
+    }
+}
@@ -0,0 +1,164 @@
+﻿using System;
+using System.Diagnostics;
+using XP.SDK;
+using XP.SDK.XPLM;
+
+namespace XP.SamplePlugin
+{
+    /// <summary>
+    /// Measures the cost of the managed dataref accessors against the datarefs defined by the sim harness
+    /// (see run_dataref_benchmark in host/sim/main.cpp). It runs when XP_SAMPLE_DATAREF_BENCHMARK is set to the number of iterations.
+    /// </summary>
+    internal static class DataRefBenchmark
+    {
+        public static void RunIfRequested()
+        {
+            if (!int.TryParse(Environment.GetEnvironmentVariable("XP_SAMPLE_DATAREF_BENCHMARK"), out var iterations) || iterations <= 0)
+                return;
+
+            var intRef = DataRef.Find("sim/benchmark/int");
+            var arrayRef = DataRef.Find("sim/benchmark/float_array");
+            if (intRef == default || arrayRef == default)
+            {
+                XPlane.Trace.WriteLine("The benchmark datarefs are not defined.");
+                return;
+            }
+
+            var sink = 0;
+            Span<float> values = stackalloc float[64];
+            var stopwatch = Stopwatch.StartNew();
+            for (var i = 0; i < iterations; i++)
+            {
+                sink += DataRef.Find("sim/benchmark/int") != default ? 1 : 0;
+            }
+            Report("DataRef.Find", iterations, stopwatch);
+
+            var intName = new DataRefName("sim/benchmark/int");
+            stopwatch.Restart();
+            for (var i = 0; i < iterations; i++)
+            {
+                sink += DataRef.Find(intName) != default ? 1 : 0;
+            }
+            Report("DataRef.Find(cached)", iterations, stopwatch);
+
+            stopwatch.Restart();
+            for (var i = 0; i < iterations; i++)
+            {
+                sink += intRef.Int32Value;
+            }
+            Report("DataRef.Int32Value get", iterations, stopwatch);
+
+            stopwatch.Restart();
+            for (var i = 0; i < iterations; i++)
+            {
+                intRef.Int32Value = i;
+            }
+            Report("DataRef.Int32Value set", iterations, stopwatch);
+
+            stopwatch.Restart();
+            for (var i = 0; i < iterations; i++)
+            {
+                sink += arrayRef.ReadValues(values, 0);
+            }
+            Report("DataRef.ReadValues[64]", iterations, stopwatch);
+
+            // A frame of a plugin which reads a few hundred datarefs, one by one and from a snapshot.
+            const int frameDataRefs = 300;
+            var frameRefs = new DataRef[frameDataRefs];
+            var frameTypes = new DataTypeID[frameDataRefs];
+            frameRefs.AsSpan().Fill(intRef);
+            frameTypes.AsSpan().Fill(DataTypeID.Int);
+            using var snapshot = new DataRefSnapshot(frameRefs, frameTypes);
+            var frames = Math.Max(iterations / frameDataRefs, 1);
+
+            stopwatch.Restart();
+            for (var frame = 0; frame < frames; frame++)
+            {
+                for (var i = 0; i < frameDataRefs; i++)
+                {
+                    sink += frameRefs[i].Int32Value;
+                }
+            }
+            Report("DataRef.Int32Value[300]", frames, stopwatch);
+
+            stopwatch.Restart();
+            for (var frame = 0; frame < frames; frame++)
+            {
+                snapshot.Read();
+                for (var i = 0; i < frameDataRefs; i++)
+                {
+                    sink += snapshot.GetInt32(i);
+                }
+            }
+            Report("DataRefSnapshot[300]", frames, stopwatch);
+
+            // A frame of a plugin which drives the elements of an array one by one, and writes an int after each of them,
+            // directly and through the write queue, which coalesces them into two calls.
+            stopwatch.Restart();
+            for (var frame = 0; frame < frames; frame++)
+            {
+                for (var i = 0; i < 64; i++)
+                {
+                    arrayRef.WriteValues(values.Slice(i, 1), i);
+                    intRef.Int32Value = i;
+                }
+            }
+            Report("DataRef.WriteValues[64]", frames, stopwatch);
+
+            stopwatch.Restart();
+            for (var frame = 0; frame < frames; frame++)
+            {
+                for (var i = 0; i < 64; i++)
+                {
+                    DataRefWriteQueue.WriteElement(arrayRef, i, values[i]);
+                    DataRefWriteQueue.Write(intRef, i);
+                }
+                DataRefWriteQueue.Flush();
+            }
+            Report("DataRefWriteQueue[64]", frames, stopwatch);
+
+            // The reads of a published dataref, as the other plugins and the instruments make them,
+            // through the managed accessors and from a native cell.
+            float floatSink = 0;
+            using (var source = new SingleSource("xpdotnet/benchmark/source"))
+            {
+                var sourceRef = DataRef.Find("xpdotnet/benchmark/source");
+                stopwatch.Restart();
+                for (var i = 0; i < iterations; i++)
+                {
+                    floatSink += sourceRef.SingleValue;
+                }
+                Report("DataRefSource get", iterations, stopwatch);
+            }
+
+            using (var cell = new DataRefCell("xpdotnet/benchmark/cell", DataTypeID.Float))
+            {
+                cell.SingleValue = 1;
+                var cellRef = cell.DataRef;
+                stopwatch.Restart();
+                for (var i = 0; i < iterations; i++)
+                {
+                    floatSink += cellRef.SingleValue;
+                }
+                Report("DataRefCell get", iterations, stopwatch);
+            }
+            GC.KeepAlive(sink);
+            GC.KeepAlive(floatSink);
+        }
+
+        private sealed class SingleSource : DataRefSource
+        {
+            public SingleSource(string name) : base(name, DataTypeID.Float, false)
+            {
+            }
+
+            protected override float SingleValue => 1;
+        }
+
+        private static void Report(string operation, int iterations, Stopwatch stopwatch)
+        {
+            var nanoseconds = stopwatch.Elapsed.TotalMilliseconds * 1e6 / iterations;
+            XPlane.Trace.WriteLine($"{operation,-24} {nanoseconds,8:F2}ns/op {1e3 / nanoseconds,10:F2}Mops/s");
+        }
+    }
+}
@@ -0,0 +1,80 @@
+﻿using System;
+using System.Text;
+using XP.SDK;
+using XP.SDK.XPLM;
+
+namespace XP.SamplePlugin
+{
+    /// <summary>
+    /// Checks the dataref cache of the host against the datarefs and the messages of the sim harness
+    /// (see run_dataref_cache_test in host/sim/main.cpp). It runs when XP_SAMPLE_DATAREF_CACHE_TEST is set,
+    /// and sets sim/test/dataref_cache/result to 1 if every check has passed, and to -1 otherwise.
+    /// </summary>
+    internal static class DataRefCacheTest
+    {
+        private const int DataRefsAddedMessage = 114;
+        private const int CheckMessage = 0x7E570000;
+
+        // hash_dataref_name("sim/flightmodel/position/latitude"), which is checked at compile time in dataref_cache.h.
+        private const ulong LatitudeHash = 0xC11AD164E8132CC3;
+
+        private static readonly DataRefName _found = new DataRefName("sim/test/dataref_cache/found");
+        private static readonly DataRefName _added = new DataRefName("sim/test/dataref_cache/added");
+
+        private static bool _running;
+        private static bool _failed;
+        private static int _addedMessages;
+
+        public static void StartIfRequested()
+        {
+            if (Environment.GetEnvironmentVariable("XP_SAMPLE_DATAREF_CACHE_TEST") == null)
+                return;
+
+            _running = true;
+            _failed = false;
+            _addedMessages = 0;
+            Check(DataRefName.ComputeHash(Encoding.UTF8.GetBytes("sim/flightmodel/position/latitude")) == LatitudeHash,
+                "The managed hash does not match hash_dataref_name.");
+
+            var found = DataRef.Find(_found);
+            Check(found != default, "The defined dataref is not found.");
+            Check(DataRef.Find(_found) == found, "The dataref found again has another handle.");
+            Check(found == DataRef.Find(_found.Name), "The cached handle differs from XPLMFindDataRef.");
+            Check(DataRef.Find(_added) == default, "The dataref which is not defined yet is found.");
+        }
+
+        public static void ReceiveMessage(int message)
+        {
+            if (!_running)
+                return;
+
+            if (message == CheckMessage)
+            {
+                // The dataref has been defined without a message, so the cached miss is still returned.
+                Check(DataRef.Find(_added.Name) != default, "The added dataref is not defined.");
+                Check(DataRef.Find(_added) == default, "The miss is not cached until XPLM_MSG_DATAREFS_ADDED.");
+            }
+            else if (message == DataRefsAddedMessage && ++_addedMessages == 1)
+            {
+                // From now on, the host caches the misses.
+                Check(DataRef.Find(_added) == default, "The dataref which is not defined yet is found.");
+            }
+            else if (message == DataRefsAddedMessage)
+            {
+                var added = DataRef.Find(_added);
+                Check(added != default && added == DataRef.Find(_added.Name), "The added dataref is not found after XPLM_MSG_DATAREFS_ADDED.");
+                DataRef.Find("sim/test/dataref_cache/result").Int32Value = _failed ? -1 : 1;
+                _running = false;
+            }
+        }
+
+        private static void Check(bool condition, string failure)
+        {
+            if (condition)
+                return;
+
+            _failed = true;
+            XPlane.Trace.WriteLine(failure);
+        }
+    }
+}
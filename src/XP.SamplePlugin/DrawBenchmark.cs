@@ -0,0 +1,48 @@
+﻿using System;
+using System.Collections.Generic;
+using XP.SDK;
+using XP.SDK.XPLM;
+
+namespace XP.SamplePlugin
+{
+    /// <summary>
+    /// Creates the windows drawn by the frames of the sim harness (see run_draw_benchmark in host/sim/main.cpp),
+    /// which reports the time spent in their managed draw functions.
+    /// It runs when XP_SAMPLE_DRAW_WINDOWS is set to the number of windows.
+    /// </summary>
+    internal static class DrawBenchmark
+    {
+        private static readonly List<Window> _windows = new List<Window>();
+        private static int _draws;
+
+        public static void StartIfRequested()
+        {
+            if (!int.TryParse(Environment.GetEnvironmentVariable("XP_SAMPLE_DRAW_WINDOWS"), out var count) || count <= 0)
+                return;
+
+            for (var i = 0; i < count; i++)
+            {
+                var window = new Window(new Rect(10 * i, 500 + 10 * i, 300 + 10 * i, 10 * i));
+                window.DrawWindow += OnDrawWindow;
+                _windows.Add(window);
+            }
+
+            // Reads the geometry like a typical draw function, which lays out its contents in the window bounds.
+            static void OnDrawWindow(Window sender, EventArgs args)
+            {
+                var geometry = sender.Geometry;
+                _draws += geometry.Width;
+            }
+        }
+
+        public static void Stop()
+        {
+            foreach (var window in _windows)
+            {
+                window.Dispose();
+            }
+            _windows.Clear();
+            GC.KeepAlive(_draws);
+        }
+    }
+}
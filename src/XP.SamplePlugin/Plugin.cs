@@ -22,12 +22,17 @@ namespace XP.SamplePlugin
         protected override bool OnEnable()
         {
             XPlane.Trace.WriteLine("Enable sample plugin.");
+            DataRefBenchmark.RunIfRequested();
+            CommandBenchmark.RunIfRequested();
+            DrawBenchmark.StartIfRequested();
+            DataRefCacheTest.StartIfRequested();
             return true;
         }
 
         protected override void OnDisable()
         {
             XPlane.Trace.WriteLine("Disable sample plugin.");
+            DrawBenchmark.Stop();
         }
 
         protected override void OnStop()
@@ -38,6 +43,7 @@ namespace XP.SamplePlugin
         protected override void OnReceiveMessage(PluginID pluginId, int message, IntPtr param)
         {
             XPlane.Trace.WriteLine($"Received message {message} from plugin {pluginId} with payload 0x{param.ToInt64():X8}.");
+            DataRefCacheTest.ReceiveMessage(message);
         }
     }
 }